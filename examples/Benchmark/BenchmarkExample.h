@@ -0,0 +1,93 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * BenchmarkExample.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef BENCHMARKEXAMPLE_H_
+#define BENCHMARKEXAMPLE_H_
+
+#include "QLBatch.h"
+#include <iostream>
+
+/*
+ * A large synthetic grid: a batch of robots start in random cells of a size x size grid
+ * and search for the nearest 'goal'. There is a goal every 16 cells in both directions, so episodes stay short
+ * while the robots keep visiting the whole grid. There are 4 actions (left, right, up, down).
+ * Table is the type of the Q-table, so the same problem can be run with doubles and with floats
+ */
+template<class Table>
+class BenchmarkExample: public QLLib::QLBatchProblem {
+public:
+	BenchmarkExample(int size, int batchSize) : QLLib::QLBatchProblem(batchSize), _size(size) {};
+	virtual ~BenchmarkExample() {};
+
+	/*
+	 * Returns the memory used by the Q-values
+	 */
+	size_t getTableBytes() {
+		return getStateCount() * getActionCount() * sizeof(typename Table::Value);
+	};
+private:
+	virtual size_t getStateCount() {
+		return static_cast<size_t>(_size) * _size;
+	};
+
+	virtual size_t getActionCount() {
+		return 4;
+	};
+
+	/*
+	 * The policy is a concrete class, so it's called without virtual dispatch
+	 */
+	virtual void setupAlgorithm() {
+		QLLib::QLAlgorithm *a = new QLLib::BasicQLearningAlgorithm<QLLib::EpsilonGreedyPolicy, Table>(0.0, 0.2, 0.95);
+		a->setPolicy(new QLLib::EpsilonGreedyPolicy(0.1));
+		setAlgorithm(a);
+	};
+
+	/*
+	 * Each episode starts in a random cell
+	 */
+	virtual int resetAgent(int agent) {
+		return QLLib::Utils::iRand(0, getStateCount() - 1);
+	};
+
+	/*
+	 * The state id is y * size + x. Hitting a wall leaves the robot where it is
+	 */
+	virtual void step(const int states[], const int actions[], int nextStates[], double rewards[], bool done[], int n) {
+		for(int i = 0; i < n; i++) {
+			int x = states[i] % _size;
+			int y = states[i] / _size;
+			switch(actions[i]) {
+				case 0: if(x > 0) x--; break;
+				case 1: if(x < _size - 1) x++; break;
+				case 2: if(y > 0) y--; break;
+				default: if(y < _size - 1) y++; break;
+			}
+			nextStates[i] = y * _size + x;
+			done[i] = ((x % 16) == 15) && ((y % 16) == 15);
+			rewards[i] = done[i] ? 100.0 : -1.0;
+		}
+	};
+
+	int _size;
+};
+
+#endif /* BENCHMARKEXAMPLE_H_ */
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * main.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#include <chrono>
+#include <string>
+#include "BenchmarkExample.h"
+
+using namespace QLLib;
+
+/*
+ * Runs the grid benchmark with a Q-table type and prints the throughput
+ */
+template<class Table>
+void run(const std::string &name, int size, int batchSize, long ticks) {
+	BenchmarkExample<Table> *example = new BenchmarkExample<Table>(size, batchSize);
+	QLBatch *batch = new QLBatch(example);
+
+	// Count the episodes and their steps
+	long episodes = 0;
+	double steps = 0.0;
+	batch->addEventListener([&](const QLLib::Utils::Stats &stats) {
+		episodes++;
+		steps += stats.stepsPerTrial;
+	});
+
+	auto start = std::chrono::steady_clock::now();
+	batch->start(ticks);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << name << ": " << (batchSize * ticks / seconds / 1e6) << "M steps/s, ";
+	std::cout << (example->getTableBytes() >> 20) << " MB of Q-values, ";
+	std::cout << episodes << " episodes (" << (episodes ? steps / episodes : 0.0) << " steps/episode)" << std::endl;
+
+	// Remember to clean-up!
+	delete batch;
+	delete example;
+}
+
+int main(int argc, char *argv[]) {
+	// The grid side (the default grid has 4M states, so the Q-table doesn't fit in the cache)
+	int size = (argc > 1) ? std::stoi(argv[1]) : 2048;
+	int batchSize = 256;
+	long ticks = 20000;
+
+	std::cout << "Grid " << size << "x" << size << ", " << batchSize << " agents, " << ticks << " ticks" << std::endl;
+	run<QLLookupTable>("double", size, batchSize, ticks);
+	run<QLFloatLookupTable>("float ", size, batchSize, ticks);
+	return 0;
+}
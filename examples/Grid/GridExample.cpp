@@ -1,35 +1,35 @@
-/*
- * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *     http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- *
- * GridExample.cpp
- *
- *  Created on: Dec 20, 2015
- *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
- */
-
-#include "QL.h"
-#include "GridExample.h"
-
-using namespace QLLib;
-
-int main(int argc, char *argv[]) {
-	QLProblem *example = new GridExample();
-	QLLib::QL *ql = new QLLib::QL(example);
-	ql->start(100);
-
-	delete ql;
-	delete example;
-	return 0;
-}
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GridExample.cpp
+ *
+ *  Created on: Dec 20, 2015
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#include "QL.h"
+#include "GridExample.h"
+
+using namespace QLLib;
+
+int main(int argc, char *argv[]) {
+	QLProblem *example = new GridExample();
+	QLLib::QL *ql = new QLLib::QL(example);
+	ql->start(100);
+
+	delete ql;
+	delete example;
+	return 0;
+}
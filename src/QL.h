@@ -1,129 +1,917 @@
-/*
- * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *     http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- *
- * QL.h
- *
- *  Created on: Dec 15, 2015
- *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
- */
-
-#ifndef QL_H_
-#define QL_H_
-
-#include "QLProblem.h"
-
-namespace QLLib {
-
-/*
- * QL Class - Controls simulation and event loop
- */
-class QL {
-public:
-	/*
-	 * The constructor initializes the QLProblem
-	 * \param p An instance of a QLProblem
-	 */
-	QL(QLLib::QLProblem *p) : _problem(p) {
-		_problem->init();
-	};
-
-	virtual ~QL() {};
-
-	/*
-	 * Start the simulation and run it 'n' times
-	 * \param n The number of times you want the simulation to run
-	 */
-	void start(int n) {
-		for (int i = 1; (i <= n && _runTrial); i++) {
-			loop();
-		}
-	};
-
-	/*
-	 * Start the simulation and run it forever
-	 */
-	void start() {
-		while(_runTrial) {
-			loop();
-		}
-	};
-
-	/*
-	 * Stop the simulation
-	 */
-	void stop() {
-		_runTrial = false;
-	};
-
-	/*
-	 * Create an event listener that notifies when a simulation ends
-	 * \param cb The callback function (lambda) that will be called when the simulation ends
-	 */
-	void addEventListener(std::function<void(QLLib::Utils::Stats)> cb) {
-		_callback = cb;
-	};
-private:
-	/*
-	 * Starts the event loop
-	 */
-	void loop() {
-		_stepsPerTrial = 0;
-		_rewardsPerTrial = 0.0;
-		QLLib::QLAgent *myAgent = _problem->getAgent();
-		_problem->getAlgorithm()->initEpisode();
-		while (!_trialEnded) {
-			_stepsPerTrial++;
-			_totalSteps++;
-			// Run the algorithm and get the resulting action
-			QLLib::QLAction *actionTaken = _problem->getAlgorithm()->step(myAgent->getCurrentState());
-			// Tell the agent which action to perform
-			myAgent->setAgentAction(actionTaken);
-			// Run action
-			actionTaken->performAction(myAgent->getCurrentState());
-			// Check if we reached the goal
-			_trialEnded = !_problem->step();
-			// Get the reward...
-			double reward = _problem->reward();
-			_rewardsPerTrial += reward;
-			// ...and pass it to the algorithm to update Q
-			_problem->getAlgorithm()->updateQ(myAgent->getPreviousState(), myAgent->getLastAction(), reward, myAgent->getCurrentState());
-		}
-		// Signal the end of the simulation
-		_problem->endOfTrial();
-		_finishedTrials++;
-		// Get some stats
-		QLLib::Utils::Stats stats;
-		stats.rewardsPerTrial = _rewardsPerTrial;
-		stats.stepsPerTrial = _stepsPerTrial;
-		stats.totalSteps = _totalSteps;
-		stats.trialsCompleted = _finishedTrials;
-		// Send the stats to the callback, if there is one
-		if(_callback != nullptr) _callback(stats);
-		_trialEnded = false;
-	};
-
-	QLLib::QLProblem *_problem;
-	bool _trialEnded = false;
-	bool _runTrial = true;
-	int _stepsPerTrial = 0;
-	int _totalSteps = 0;
-	double _rewardsPerTrial = 0.0;
-	int _finishedTrials = 0;
-	std::function<void(QLLib::Utils::Stats)> _callback = nullptr;
-};
-
-} /* namespace QLLib */
-
-#endif /* QL_H_ */
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QL.h
+ *
+ *  Created on: Dec 15, 2015
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QL_H_
+#define QL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "QLProblem.h"
+#include "QLNotifier.h"
+#include "QLMetricsSink.h"
+
+namespace QLLib {
+namespace Utils {
+
+/*
+ * EvaluationOptions Struct
+ * The options of QL::evaluate()
+ */
+struct EvaluationOptions {
+	// The number of threads that run episodes
+	int threads = 1;
+	// The number of steps after which an episode is stopped, 0 for no limit (a greedy policy can loop forever)
+	int maxSteps = 0;
+	// Creates the problem a thread runs its episodes on. It must add the same states, in the same order, the same actions
+	// and the same agents as the simulation's problem, and neither problem can create states on demand (the ids wouldn't match).
+	// It's required for more than one thread, or while the simulation runs: without it the episodes run on the simulation's problem
+	std::function<QLLib::QLProblem*()> createProblem;
+	// Creates the policy a thread chooses actions with. Without it actions are greedy (the largest Q-value)
+	std::function<QLLib::QLPolicy*()> createPolicy;
+};
+
+} /* namespace Utils */
+
+// see QLSnapshotTable.h
+template<class T> class QLTableSnapshot;
+
+/*
+ * BasicQL Class - Controls simulation and event loop
+ * BasicQL is specialized at compile time on the problem and algorithm types.
+ * When they are concrete classes, every call in the inner loop is bound statically, so the compiler can inline
+ * the whole step (i.e. BasicQL<MyProblem, QLLib::BasicQLearningAlgorithm<QLLib::EpsilonGreedyPolicy>>).
+ * Note that the problem's step(), reward() and endOfTrial() methods must be accessible to BasicQL:
+ * either make them public or declare BasicQL a friend of your problem class.
+ * When they are abstract (QLProblem, QLAlgorithm) calls are dispatched virtually, which is what QL does.
+ * Statically bound calls skip overrides, so the problem and the algorithms must be exactly of the concrete types:
+ * the constructor rejects subclasses of them (use the subclass as the template argument instead).
+ */
+template<class Problem, class Algorithm>
+class BasicQL {
+public:
+	/*
+	 * The constructor initializes the QLProblem
+	 * \param p An instance of a QLProblem
+	 */
+	BasicQL(Problem *p) : _problem(p) {
+		if(!QLLib::Utils::isStaticType<Problem>(p)) {
+			std::cout << "[ERROR] The problem is a subclass of the problem type of the simulation, its overrides wouldn't be called" << std::endl;
+			exit(1);
+		}
+		_problem->init();
+		// each agent is driven by its own algorithm or by the problem's shared one
+		for(int i = 0; i < _problem->getAgentCount(); i++) {
+			Algorithm *algorithm = dynamic_cast<Algorithm*>(_problem->getAgentAlgorithm(i));
+			if(algorithm == nullptr) {
+				std::cout << "[ERROR] The problem's algorithm doesn't match the algorithm type of the simulation" << std::endl;
+				exit(1);
+			}
+			if(!QLLib::Utils::isStaticType<Algorithm>(algorithm)) {
+				std::cout << "[ERROR] The problem's algorithm is a subclass of the algorithm type of the simulation, its overrides wouldn't be called" << std::endl;
+				exit(1);
+			}
+			_algorithms.push_back(algorithm);
+			if(std::find(_distinctAlgorithms.begin(), _distinctAlgorithms.end(), algorithm) == _distinctAlgorithms.end()) {
+				_distinctAlgorithms.push_back(algorithm);
+			}
+		}
+	};
+
+	/*
+	 * The destructor stops the simulation started by startAsync() and waits for it to end
+	 */
+	virtual ~BasicQL() {
+		if(_worker.joinable()) {
+			stop();
+			_worker.join();
+		}
+	};
+
+	/*
+	 * Start the simulation and run it 'n' times
+	 * Throws std::logic_error if the simulation is already running (i.e. on a worker thread, see startAsync())
+	 * \param n The number of times you want the simulation to run
+	 */
+	void start(int n) {
+		claim();
+		run(n);
+	};
+
+	/*
+	 * Start the simulation and run it forever
+	 */
+	void start() {
+		claim();
+		run(-1);
+	};
+
+	/*
+	 * Start the simulation on a worker thread and run it 'n' times
+	 * Returns a future that becomes ready when the simulation ends (and rethrows its exceptions, if any).
+	 * Listeners are called on the worker thread. Throws std::logic_error if the simulation is already running
+	 * \param n The number of times you want the simulation to run
+	 */
+	std::future<void> startAsync(int n) {
+		return launch(n);
+	};
+
+	/*
+	 * Start the simulation on a worker thread and run it until stop() is called
+	 */
+	std::future<void> startAsync() {
+		return launch(-1);
+	};
+
+	/*
+	 * Stop the simulation
+	 * The simulation stops before its next step: an interrupted trial ends (endOfTrial() is called) but it's not reported.
+	 * Safe to call from any thread.
+	 */
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(_controlMutex);
+			_runTrial.store(false);
+			_interrupt.store(true);
+		}
+		_controlCv.notify_all();
+	};
+
+	/*
+	 * Pause the simulation before its next step. Safe to call from any thread
+	 */
+	void pause() {
+		std::lock_guard<std::mutex> lock(_controlMutex);
+		_paused.store(true);
+		_interrupt.store(true);
+	};
+
+	/*
+	 * Resume a paused simulation. Safe to call from any thread
+	 */
+	void resume() {
+		{
+			std::lock_guard<std::mutex> lock(_controlMutex);
+			_paused.store(false);
+		}
+		_controlCv.notify_all();
+	};
+
+	/*
+	 * Returns true if the simulation is paused (or will pause before its next step)
+	 */
+	bool isPaused() const {
+		return _paused.load();
+	};
+
+	/*
+	 * Returns true while the simulation is running (paused simulations are still running)
+	 */
+	bool isRunning() const {
+		return _running.load();
+	};
+
+	/*
+	 * Returns the progress of the simulation: the number of completed trials, the total number of steps
+	 * and the steps and rewards of the last completed trial. Safe to call from any thread,
+	 * though the values are updated independently and may be one step apart.
+	 */
+	QLLib::Utils::Stats getProgress() const {
+		QLLib::Utils::Stats stats;
+		stats.trialsCompleted = _progressTrials.load(std::memory_order_relaxed);
+		stats.totalSteps = _progressSteps.load(std::memory_order_relaxed);
+		stats.stepsPerTrial = _progressStepsPerTrial.load(std::memory_order_relaxed);
+		stats.rewardsPerTrial = _progressRewardsPerTrial.load(std::memory_order_relaxed);
+		return stats;
+	};
+
+	/*
+	 * Runs a command on the simulation's thread, between two steps.
+	 * This is how the simulation's objects (the problem, algorithms and policies) can be changed safely while it runs.
+	 * If the simulation isn't running, the command runs before its first step.
+	 * \param command The command (lambda)
+	 */
+	void post(std::function<void()> command) {
+		{
+			std::lock_guard<std::mutex> lock(_controlMutex);
+			_commands.push_back(command);
+			_interrupt.store(true);
+		}
+		_controlCv.notify_all();
+	};
+
+	/*
+	 * Changes the learning rate of all the simulation's algorithms, without restarting. Safe to call from any thread
+	 */
+	void setAlpha(double alpha) {
+		post([this, alpha]() {
+			for(auto i : _algorithms) i->setAlpha(alpha);
+		});
+	};
+
+	/*
+	 * Changes the discount factor of all the simulation's algorithms, without restarting. Safe to call from any thread
+	 */
+	void setGamma(double gamma) {
+		post([this, gamma]() {
+			for(auto i : _algorithms) i->setGamma(gamma);
+		});
+	};
+
+	/*
+	 * Changes the epsilon of the algorithms that use an EpsilonGreedyPolicy, without restarting. Safe to call from any thread
+	 */
+	void setEpsilon(double epsilon) {
+		post([this, epsilon]() {
+			for(auto i : _algorithms) {
+				QLLib::EpsilonGreedyPolicy *policy = dynamic_cast<QLLib::EpsilonGreedyPolicy*>(i->getPolicy());
+				if(policy != nullptr) policy->setEpsilon(epsilon);
+			}
+		});
+	};
+
+	/*
+	 * Changes the temperature of the algorithms that use a SoftmaxPolicy, without restarting. Safe to call from any thread
+	 */
+	void setTemperature(double temperature) {
+		post([this, temperature]() {
+			for(auto i : _algorithms) {
+				QLLib::SoftmaxPolicy *policy = dynamic_cast<QLLib::SoftmaxPolicy*>(i->getPolicy());
+				if(policy != nullptr) policy->setTemperature(temperature);
+			}
+		});
+	};
+
+	/*
+	 * Evaluates what the algorithms learned: runs 'n' greedy episodes without updating the Q-values
+	 * and returns statistics of their returns (the rewards of all agents)
+	 * \param n The number of episodes
+	 */
+	QLLib::Utils::EvaluationStats evaluate(int n) {
+		return evaluate(n, QLLib::Utils::EvaluationOptions());
+	};
+
+	/*
+	 * Evaluates what the algorithms learned: runs 'n' episodes without updating the Q-values
+	 * and returns statistics of their returns (the rewards of all agents).
+	 * The algorithms are only read, so episodes can run on several threads, as long as each thread runs on its own problem
+	 * (see EvaluationOptions). Evaluating alongside the simulation on a worker thread (see startAsync()) also needs
+	 * algorithms that can be read while they learn (see QLAlgorithm::hasConcurrentReads()), otherwise evaluate a snapshot
+	 * of the table instead (see the overload below).
+	 * If an episode throws, the other threads stop and the exception is rethrown on the calling thread
+	 * \param n The number of episodes
+	 * \param options The threads, the step limit and how to create each thread's problem and policy
+	 */
+	QLLib::Utils::EvaluationStats evaluate(int n, const QLLib::Utils::EvaluationOptions &options) {
+		if(_running.load()) {
+			for(auto i : _distinctAlgorithms) {
+				if(!i->hasConcurrentReads()) {
+					std::cout << "[ERROR] evaluate() can't read the algorithms while the simulation runs, their Q-tables can grow: "
+							"evaluate a snapshot of a QLSnapshotTable instead" << std::endl;
+					exit(1);
+				}
+			}
+		}
+		return evaluateWith(n, options, [this](int agent, int stateId, double Q[]) {
+			_algorithms[agent]->getQValues(stateId, Q);
+		});
+	};
+
+	/*
+	 * Evaluates a snapshot of a Q-table (see QLSnapshotTable.h) like evaluate(n, options) evaluates the algorithms:
+	 * every agent chooses its actions from the snapshot's Q-values and the algorithm's action mask.
+	 * The snapshot doesn't change while the table learns, so this can run alongside the simulation on a worker thread:
+	 *
+	 * 		auto snapshot = algorithm->getTable().snapshot(); // on the training thread, i.e. in an event listener
+	 * 		QLLib::Utils::EvaluationStats stats = ql.evaluate(snapshot, 100, options); // on any thread
+	 *
+	 * All agents must share the algorithm the snapshot was taken from.
+	 * \param snapshot The snapshot, taken with BasicQLSnapshotTable::snapshot()
+	 * \param n The number of episodes
+	 * \param options The threads, the step limit and how to create each thread's problem and policy
+	 */
+	template<class T>
+	QLLib::Utils::EvaluationStats evaluate(const QLLib::QLTableSnapshot<T> &snapshot, int n, const QLLib::Utils::EvaluationOptions &options) {
+		if(_distinctAlgorithms.size() != 1) {
+			std::cout << "[ERROR] evaluate() can only evaluate a snapshot when all agents share one algorithm" << std::endl;
+			exit(1);
+		}
+		if(snapshot.getActionCount() != _problem->getAllActions().size()) {
+			std::cout << "[ERROR] The snapshot doesn't have an action for each action of the problem" << std::endl;
+			exit(1);
+		}
+		return evaluateWith(n, options, [&snapshot](int, int stateId, double Q[]) {
+			snapshot.copyRow(stateId, Q);
+		});
+	};
+
+	/*
+	 * Create an event listener that notifies when a simulation ends
+	 * The listener is called synchronously, so it should return quickly.
+	 * You can add as many listeners as you like.
+	 * \param cb The callback function (lambda) that will be called when the simulation ends
+	 */
+	void addEventListener(std::function<void(const QLLib::Utils::Stats&)> cb) {
+		_listeners.push_back(cb);
+	};
+
+	/*
+	 * Adds a stopping criterion: the simulation stops as soon as the criterion returns true for a finished trial.
+	 * Stats include how much the Q-values changed during the trial (maxDeltaQ, meanDeltaQ and policyChanges)
+	 * \param criterion The criterion (lambda), called with the stats of each finished trial
+	 */
+	void addStoppingCriterion(std::function<bool(const QLLib::Utils::Stats&)> criterion) {
+		_criteria.push_back(criterion);
+	};
+
+	/*
+	 * Stops the simulation when no Q-value changed by 'tolerance' or more for 'trials' consecutive trials
+	 * \param tolerance The largest change of a Q-value that is considered negligible
+	 * \param trials The number of consecutive trials
+	 */
+	void stopWhenConverged(double tolerance, int trials) {
+		int consecutive = 0;
+		addStoppingCriterion([tolerance, trials, consecutive](const QLLib::Utils::Stats &stats) mutable {
+			consecutive = (stats.maxDeltaQ < tolerance) ? consecutive + 1 : 0;
+			return consecutive >= trials;
+		});
+	};
+
+	/*
+	 * Stops the simulation when the greedy action of every visited state stayed the same for 'trials' consecutive trials
+	 * This enables policy change tracking in the simulation's algorithms
+	 * \param trials The number of consecutive trials
+	 */
+	void stopWhenPolicyStable(int trials) {
+		for(auto i : _distinctAlgorithms) i->setPolicyChangeTracking(true);
+		int consecutive = 0;
+		addStoppingCriterion([trials, consecutive](const QLLib::Utils::Stats &stats) mutable {
+			consecutive = (stats.policyChanges == 0) ? consecutive + 1 : 0;
+			return consecutive >= trials;
+		});
+	};
+
+	/*
+	 * Returns true if the last run was stopped by one of its stopping criteria
+	 */
+	bool hasConverged() const {
+		return _converged.load();
+	};
+
+	/*
+	 * Limits the steps of each trial, and the steps, trials and time of each run (each call to start()).
+	 * A trial that reaches a limit ends like any other trial (endOfTrial() is called and it's reported to the listeners),
+	 * but its stats are marked as truncated and the algorithms are told it didn't reach a terminal state.
+	 * When a run limit is reached the run stops; the next call to start() begins a new run.
+	 * Call this before the simulation starts
+	 * \param budget The limits
+	 */
+	void setBudget(const QLLib::Utils::Budget &budget) {
+		_budget = budget;
+	};
+
+	/*
+	 * Returns true if the last run was stopped because it reached one of its budget's limits
+	 */
+	bool isBudgetExhausted() const {
+		return _budgetExhausted.load();
+	};
+
+	/*
+	 * Create an event listener that receives the stats of finished simulations in batches.
+	 * The listener runs on its own notifier thread, so slow listeners (i.e. logging) don't stall learning.
+	 * Pending stats are delivered when the QL instance is destroyed.
+	 * \param cb The callback function (lambda) that will be called with each batch
+	 * \param options Batch size, delivery interval, queue capacity and overflow policy
+	 */
+	void addBatchEventListener(QLLib::QLNotifier::BatchCallback cb, QLLib::Utils::NotifierOptions options = QLLib::Utils::NotifierOptions()) {
+		_notifiers.push_back(std::unique_ptr<QLLib::QLNotifier>(new QLLib::QLNotifier(cb, options)));
+	};
+
+	/*
+	 * Streams the stats of finished simulations to CSV or binary files (see QLMetricsSink).
+	 * The files are written by a batch event listener, so learning never waits for the disk and memory use stays
+	 * bounded; when the queue is full, learning waits rather than losing stats.
+	 * The files are complete when the QL instance is destroyed.
+	 * Returns the sink, i.e. to check if it stopped because a file couldn't be written (see QLMetricsSink::getError())
+	 * \param path The name of the files, without extension
+	 * \param options The format, rotation, buffer size and downsampling
+	 */
+	const QLLib::QLMetricsSink* addMetricsSink(const std::string &path, QLLib::Utils::MetricsOptions options = QLLib::Utils::MetricsOptions()) {
+		_sinks.push_back(std::unique_ptr<QLLib::QLMetricsSink>(new QLLib::QLMetricsSink(path, options)));
+		QLLib::QLMetricsSink *sink = _sinks.back().get();
+		QLLib::Utils::NotifierOptions notifierOptions;
+		notifierOptions.batchTrials = 1024;
+		notifierOptions.batchMillis = 1000;
+		notifierOptions.queueCapacity = 4096;
+		notifierOptions.sampleEvery = options.sampleEvery;
+		addBatchEventListener([sink](const std::vector<QLLib::Utils::Stats> &batch) { sink->write(batch); }, notifierOptions);
+		return sink;
+	};
+private:
+	/*
+	 * Starts the event loop
+	 * Every tick steps each agent that hasn't finished the trial yet, and the trial ends when all agents have finished
+	 */
+	void loop() {
+		_stepsPerTrial = 0;
+		_rewardsPerTrial = 0.0;
+		int agents = _algorithms.size();
+		_agentsInTrial.assign(agents, true);
+		for(int i = 0; i < agents; i++) {
+			_problem->selectAgent(i);
+			algorithmSelectAgent(_algorithms[i], i, StaticAlgorithm());
+			algorithmInitEpisode(_algorithms[i], StaticAlgorithm());
+		}
+		// Set the scheduled parameters (i.e. a decaying epsilon)
+		bool stepSchedules = false;
+		for(auto i : _distinctAlgorithms) {
+			i->updateSchedules(QLLib::QLSchedule::PerTrial, _finishedTrials);
+			i->updateSchedules(QLLib::QLSchedule::PerStep, _totalSteps);
+			stepSchedules = stepSchedules || i->hasSchedules(QLLib::QLSchedule::PerStep);
+		}
+		int running = agents;
+		int stepLimit = trialStepLimit();
+		bool truncated = false;
+		while (running > 0) {
+			// a single relaxed load per tick: stop, pause and posted commands are handled out of line
+			if(_interrupt.load(std::memory_order_relaxed) && !handleInterrupt()) break;
+			if((stepLimit > 0) && (_stepsPerTrial >= stepLimit)) {
+				truncated = true;
+				break;
+			}
+			// the clock is only read every 256 steps
+			if(_hasDeadline && ((_stepsPerTrial & 255) == 255) && (std::chrono::steady_clock::now() >= _deadline)) {
+				_budgetExhausted.store(true);
+				truncated = true;
+				break;
+			}
+			if(stepSchedules) {
+				for(auto i : _distinctAlgorithms) i->updateSchedules(QLLib::QLSchedule::PerStep, _totalSteps);
+			}
+			_stepsPerTrial++;
+			_totalSteps++;
+			_progressSteps.store(_totalSteps, std::memory_order_relaxed);
+			for(int i = 0; i < agents; i++) {
+				if(!_agentsInTrial[i]) continue;
+				if(!stepAgent(i)) {
+					_agentsInTrial[i] = false;
+					running--;
+				}
+			}
+		}
+		// Signal the end of the simulation to each agent, and to its algorithm (agents still in the trial were cut short)
+		for(int i = 0; i < agents; i++) {
+			_problem->selectAgent(i);
+			algorithmSelectAgent(_algorithms[i], i, StaticAlgorithm());
+			algorithmEndEpisode(_algorithms[i], _agentsInTrial[i], StaticAlgorithm());
+			problemEndOfTrial(_problem, StaticProblem());
+		}
+		_problem->selectAgent(0);
+		// Collect how much the Q-values changed
+		QLLib::Utils::Convergence convergence;
+		for(auto i : _distinctAlgorithms) {
+			convergence.merge(i->getConvergence());
+			i->resetConvergence();
+		}
+		if((running > 0) && !truncated) return;
+		_finishedTrials++;
+		_progressStepsPerTrial.store(_stepsPerTrial, std::memory_order_relaxed);
+		_progressRewardsPerTrial.store(_rewardsPerTrial, std::memory_order_relaxed);
+		_progressTrials.store(_finishedTrials, std::memory_order_relaxed);
+		// Get some stats
+		QLLib::Utils::Stats stats;
+		stats.rewardsPerTrial = _rewardsPerTrial;
+		stats.stepsPerTrial = _stepsPerTrial;
+		stats.totalSteps = _totalSteps;
+		stats.trialsCompleted = _finishedTrials;
+		stats.maxDeltaQ = convergence.maxDeltaQ;
+		stats.meanDeltaQ = convergence.meanDeltaQ();
+		stats.policyChanges = convergence.policyChanges;
+		stats.truncated = truncated;
+		// Send the stats to the listeners, if there are any
+		for(auto &listener : _listeners) listener(stats);
+		for(auto &notifier : _notifiers) notifier->notify(stats);
+		// Check if learning has converged
+		for(auto &criterion : _criteria) {
+			if(criterion(stats)) {
+				_converged.store(true);
+				_runTrial.store(false);
+				break;
+			}
+		}
+		if(runLimitReached()) _budgetExhausted.store(true);
+	};
+
+	/*
+	 * Clears the flags of the previous run (a stop() that ended it) and starts counting the run's budget.
+	 * A pause and the commands posted before the run are kept, they're handled before its first step
+	 */
+	void beginRun() {
+		{
+			std::lock_guard<std::mutex> lock(_controlMutex);
+			_runTrial.store(true);
+			_interrupt.store(_paused.load() || !_commands.empty());
+		}
+		_budgetExhausted.store(false);
+		_converged.store(false);
+		_runStartSteps = _totalSteps;
+		_runStartTrials = _finishedTrials;
+		_hasDeadline = (_budget.maxSeconds > 0.0);
+		if(_hasDeadline) {
+			_deadline = std::chrono::steady_clock::now() +
+					std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(_budget.maxSeconds));
+		}
+	};
+
+	/*
+	 * Returns the number of steps the next trial can take (0 if there's no limit): the per-trial limit,
+	 * or the steps left in the run if there are fewer
+	 */
+	int trialStepLimit() const {
+		int64_t limit = _budget.maxStepsPerTrial;
+		if(_budget.maxSteps > 0) {
+			int64_t left = std::max<int64_t>(1, _budget.maxSteps - (_totalSteps - _runStartSteps));
+			if((limit <= 0) || (left < limit)) limit = left;
+		}
+		return static_cast<int>(std::min<int64_t>(limit, std::numeric_limits<int>::max()));
+	};
+
+	/*
+	 * Returns true if the run used all of its steps, trials or time
+	 */
+	bool runLimitReached() const {
+		return ((_budget.maxSteps > 0) && (_totalSteps - _runStartSteps >= _budget.maxSteps)) ||
+				((_budget.maxTrials > 0) && (_finishedTrials - _runStartTrials >= _budget.maxTrials)) ||
+				(_hasDeadline && (std::chrono::steady_clock::now() >= _deadline));
+	};
+
+	/*
+	 * Performs one step of an agent, returns false if the agent reached the end of the trial
+	 * \param index The index of the agent
+	 */
+	bool stepAgent(int index) {
+		// Make the agent the problem's current agent, so actions, step() and reward() refer to it
+		_problem->selectAgent(index);
+		Algorithm *algorithm = _algorithms[index];
+		algorithmSelectAgent(algorithm, index, StaticAlgorithm());
+		QLLib::QLAgent *myAgent = _problem->getAgent();
+		// Run the algorithm and get the resulting action
+		QLLib::QLAction *actionTaken = algorithmStep(algorithm, myAgent->getCurrentState(), StaticAlgorithm());
+		// Tell the agent which action to perform
+		myAgent->setAgentAction(actionTaken);
+		// Run action
+		actionTaken->performAction(myAgent->getCurrentState());
+		// Check if we reached the goal
+		bool goOn = problemStep(_problem, StaticProblem());
+		// Get the reward...
+		double reward = problemReward(_problem, StaticProblem());
+		_rewardsPerTrial += reward;
+		// ...and pass it to the algorithm to update Q (without bootstrapping from a terminal state)
+		if(goOn) {
+			algorithmUpdateQ(algorithm, myAgent->getPreviousState(), myAgent->getLastAction(), reward, myAgent->getCurrentState(), StaticAlgorithm());
+		} else {
+			algorithmUpdateQTerminal(algorithm, myAgent->getPreviousState(), myAgent->getLastAction(), reward, myAgent->getCurrentState(), StaticAlgorithm());
+		}
+		return goOn;
+	};
+
+	/*
+	 * Runs the posted commands and waits while the simulation is paused, returns false if the simulation was stopped
+	 */
+	bool handleInterrupt() {
+		std::unique_lock<std::mutex> lock(_controlMutex);
+		_interrupt.store(false);
+		for(;;) {
+			while(!_commands.empty()) {
+				std::vector<std::function<void()>> commands;
+				commands.swap(_commands);
+				lock.unlock();
+				for(auto &command : commands) command();
+				lock.lock();
+			}
+			if(!_runTrial.load() || !_paused.load()) break;
+			_controlCv.wait(lock, [this]() {
+				return !_runTrial.load() || !_paused.load() || !_commands.empty();
+			});
+		}
+		return _runTrial.load();
+	};
+
+	// Reads the Q-values of a state for an agent (agent, state id, output array), see evaluateWith()
+	typedef std::function<void(int, int, double[])> QValueReader;
+
+	/*
+	 * Runs the episodes of evaluate() on one or more threads, reading the Q-values of each agent with 'getQValues'
+	 */
+	QLLib::Utils::EvaluationStats evaluateWith(int n, const QLLib::Utils::EvaluationOptions &options, const QValueReader &getQValues) {
+		int threads = std::max(1, options.threads);
+		if(!options.createProblem && ((threads > 1) || _running.load())) {
+			std::cout << "[ERROR] evaluate() needs EvaluationOptions::createProblem to run on several threads or while the simulation runs" << std::endl;
+			exit(1);
+		}
+		// create the problems and policies up front, so the factories are only called from this thread
+		std::vector<std::unique_ptr<QLLib::QLProblem>> problems;
+		std::vector<std::unique_ptr<QLLib::QLPolicy>> policies;
+		for(int i = 0; i < threads; i++) {
+			if(options.createProblem) {
+				problems.push_back(std::unique_ptr<QLLib::QLProblem>(options.createProblem()));
+				problems.back()->init();
+				if((dynamic_cast<Problem*>(problems.back().get()) == nullptr) ||
+						(problems.back()->getAgentCount() != _problem->getAgentCount()) ||
+						(problems.back()->getAllActions().size() != _problem->getAllActions().size())) {
+					std::cout << "[ERROR] EvaluationOptions::createProblem must create problems like the simulation's problem" << std::endl;
+					exit(1);
+				}
+				// the episodes read the Q-tables and masks by state id, so the ids must match the simulation's problem
+				if(problems.back()->isStatesOnDemand() || _problem->isStatesOnDemand() ||
+						(problems.back()->getAllStates().size() != _problem->getAllStates().size())) {
+					std::cout << "[ERROR] EvaluationOptions::createProblem must create problems that add all their states up front, in the same order as the simulation's problem" << std::endl;
+					exit(1);
+				}
+			}
+			policies.push_back(std::unique_ptr<QLLib::QLPolicy>(options.createPolicy ? options.createPolicy() : nullptr));
+		}
+		std::atomic<int> next{0};
+		std::vector<Rollouts> results(threads);
+		// an exception stops the thread that threw it and is rethrown here once every thread has been joined
+		std::vector<std::exception_ptr> errors(threads);
+		std::vector<std::thread> workers;
+		for(int i = 1; i < threads; i++) {
+			workers.push_back(std::thread([&, i]() {
+				try {
+					rollouts(static_cast<Problem*>(problems[i].get()), policies[i].get(), n, options.maxSteps, getQValues, next, results[i]);
+				} catch(...) {
+					errors[i] = std::current_exception();
+					next.store(n);
+				}
+			}));
+		}
+		Problem *problem = problems.empty() ? _problem : static_cast<Problem*>(problems[0].get());
+		try {
+			rollouts(problem, policies[0].get(), n, options.maxSteps, getQValues, next, results[0]);
+		} catch(...) {
+			errors[0] = std::current_exception();
+			next.store(n);
+		}
+		for(auto &worker : workers) worker.join();
+		for(auto &error : errors) {
+			if(error) std::rethrow_exception(error);
+		}
+		// Merge the threads' results
+		Rollouts total;
+		for(auto &r : results) total.merge(r);
+		QLLib::Utils::EvaluationStats stats;
+		stats.episodes = total.episodes;
+		stats.truncated = total.truncated;
+		if(total.episodes > 0) {
+			stats.meanReturn = total.sumReturns / total.episodes;
+			stats.stdReturn = std::sqrt(std::max(0.0, total.sumSquaredReturns / total.episodes - stats.meanReturn * stats.meanReturn));
+			stats.minReturn = total.minReturn;
+			stats.maxReturn = total.maxReturn;
+			stats.meanSteps = static_cast<double>(total.steps) / total.episodes;
+		}
+		return stats;
+	};
+
+	// The returns of the episodes run by a thread of evaluate()
+	struct Rollouts {
+		int episodes = 0;
+		int truncated = 0;
+		long steps = 0;
+		double sumReturns = 0.0;
+		double sumSquaredReturns = 0.0;
+		double minReturn = 0.0;
+		double maxReturn = 0.0;
+
+		void add(double r) {
+			minReturn = (episodes == 0) ? r : std::min(minReturn, r);
+			maxReturn = (episodes == 0) ? r : std::max(maxReturn, r);
+			sumReturns += r;
+			sumSquaredReturns += r * r;
+			episodes++;
+		};
+
+		void merge(const Rollouts &r) {
+			if(r.episodes == 0) return;
+			minReturn = (episodes == 0) ? r.minReturn : std::min(minReturn, r.minReturn);
+			maxReturn = (episodes == 0) ? r.maxReturn : std::max(maxReturn, r.maxReturn);
+			episodes += r.episodes;
+			truncated += r.truncated;
+			steps += r.steps;
+			sumReturns += r.sumReturns;
+			sumSquaredReturns += r.sumSquaredReturns;
+		};
+	};
+
+	/*
+	 * Runs episodes on a problem until 'n' episodes have been started by all threads
+	 * Each tick every agent that hasn't finished chooses an action from its algorithm's Q-values, without updating them
+	 */
+	void rollouts(Problem *problem, QLLib::QLPolicy *policy, int n, int maxSteps, const QValueReader &getQValues,
+			std::atomic<int> &next, Rollouts &result) {
+		const std::vector<QLLib::QLAction*> &actions = problem->getAllActions();
+		std::vector<double> q(actions.size());
+		std::vector<double> masked(actions.size());
+		int agents = _algorithms.size();
+		std::vector<bool> inTrial;
+		while(next.fetch_add(1) < n) {
+			inTrial.assign(agents, true);
+			int running = agents;
+			int steps = 0;
+			double reward = 0.0;
+			while((running > 0) && ((maxSteps <= 0) || (steps < maxSteps))) {
+				steps++;
+				for(int i = 0; i < agents; i++) {
+					if(!inTrial[i]) continue;
+					problem->selectAgent(i);
+					QLLib::QLAgent *myAgent = problem->getAgent();
+					QLLib::QLState *state = myAgent->getCurrentState();
+					getQValues(i, state->getId(), &q[0]);
+					const QLLib::QLActionMask *mask = _algorithms[i]->getActionMask();
+					int a;
+					if(mask != nullptr) {
+						// choose among the valid actions only, like the algorithm
+						const uint16_t *valid;
+						int count = mask->getActions(state->getId(), valid);
+						if(count == 0) {
+							throw std::logic_error("[ERROR] The agent is in a state without valid actions, step() must end the trial there");
+						}
+						for(int j = 0; j < count; j++) masked[j] = q[valid[j]];
+						a = valid[(policy != nullptr) ? policy->sampleAction(&masked[0], count) : QLLib::Utils::indexOfLargest(&masked[0], count)];
+					} else {
+						a = (policy != nullptr) ? policy->sampleAction(&q[0], q.size()) : QLLib::Utils::indexOfLargest(&q[0], q.size());
+					}
+					myAgent->setAgentAction(actions[a]);
+					actions[a]->performAction(state);
+					bool goOn = problemStep(problem, StaticProblem());
+					reward += problemReward(problem, StaticProblem());
+					if(!goOn) {
+						inTrial[i] = false;
+						running--;
+					}
+				}
+			}
+			for(int i = 0; i < agents; i++) {
+				problem->selectAgent(i);
+				problemEndOfTrial(problem, StaticProblem());
+			}
+			problem->selectAgent(0);
+			if(running > 0) result.truncated++;
+			result.steps += steps;
+			result.add(reward);
+		}
+	};
+
+	/*
+	 * Marks the simulation as running and starts a new run, or throws std::logic_error if it's already running.
+	 * Called on the caller's thread, so two calls can't both start the simulation, and a stop() that follows
+	 * startAsync() can't be undone by the worker starting late
+	 */
+	void claim() {
+		if(_running.exchange(true)) {
+			throw std::logic_error("[ERROR] The simulation is already running, stop() it or wait for it to end before starting it again");
+		}
+		beginRun();
+	};
+
+	/*
+	 * Runs 'n' trials (forever if n is negative) of a claimed simulation
+	 */
+	void run(int n) {
+		try {
+			for(int64_t i = 1; ((n < 0) || (i <= n)) && _runTrial.load(std::memory_order_relaxed) && !_budgetExhausted.load(std::memory_order_relaxed); i++) {
+				loop();
+			}
+		} catch(...) {
+			_running.store(false);
+			throw;
+		}
+		_running.store(false);
+	};
+
+	std::future<void> launch(int n) {
+		claim();
+		// the previous worker has finished run(), joining it doesn't block
+		if(_worker.joinable()) _worker.join();
+		std::packaged_task<void()> task([this, n]() { run(n); });
+		std::future<void> result = task.get_future();
+		_worker = std::thread(std::move(task));
+		return result;
+	};
+
+	/*
+	 * Dispatch helpers: calls qualified with the concrete type are bound at compile time,
+	 * calls on abstract types go through the vtable
+	 */
+	typedef QLLib::Utils::IsStatic<Problem> StaticProblem;
+	typedef QLLib::Utils::IsStatic<Algorithm> StaticAlgorithm;
+
+	bool problemStep(Problem *p, std::false_type) { return p->step(); };
+	bool problemStep(Problem *p, std::true_type) { return p->Problem::step(); };
+	double problemReward(Problem *p, std::false_type) { return p->reward(); };
+	double problemReward(Problem *p, std::true_type) { return p->Problem::reward(); };
+	void problemEndOfTrial(Problem *p, std::false_type) { p->endOfTrial(); };
+	void problemEndOfTrial(Problem *p, std::true_type) { p->Problem::endOfTrial(); };
+
+	void algorithmInitEpisode(Algorithm *a, std::false_type) { a->initEpisode(); };
+	void algorithmInitEpisode(Algorithm *a, std::true_type) { a->Algorithm::initEpisode(); };
+	void algorithmSelectAgent(Algorithm *a, int i, std::false_type) { a->selectAgent(i); };
+	void algorithmSelectAgent(Algorithm *a, int i, std::true_type) { a->Algorithm::selectAgent(i); };
+	void algorithmEndEpisode(Algorithm *a, bool truncated, std::false_type) { a->endEpisode(truncated); };
+	void algorithmEndEpisode(Algorithm *a, bool truncated, std::true_type) { a->Algorithm::endEpisode(truncated); };
+	QLLib::QLAction* algorithmStep(Algorithm *a, QLLib::QLState *s, std::false_type) { return a->step(s); };
+	QLLib::QLAction* algorithmStep(Algorithm *a, QLLib::QLState *s, std::true_type) { return a->Algorithm::step(s); };
+	void algorithmUpdateQ(Algorithm *a, QLLib::QLState *s1, QLLib::QLAction *action, double r, QLLib::QLState *s2, std::false_type) {
+		a->updateQ(s1, action, r, s2);
+	};
+	void algorithmUpdateQ(Algorithm *a, QLLib::QLState *s1, QLLib::QLAction *action, double r, QLLib::QLState *s2, std::true_type) {
+		a->Algorithm::updateQ(s1, action, r, s2);
+	};
+	void algorithmUpdateQTerminal(Algorithm *a, QLLib::QLState *s1, QLLib::QLAction *action, double r, QLLib::QLState *s2, std::false_type) {
+		a->updateQTerminal(s1, action, r, s2);
+	};
+	void algorithmUpdateQTerminal(Algorithm *a, QLLib::QLState *s1, QLLib::QLAction *action, double r, QLLib::QLState *s2, std::true_type) {
+		a->Algorithm::updateQTerminal(s1, action, r, s2);
+	};
+
+	Problem *_problem;
+	std::vector<Algorithm*> _algorithms;
+	std::vector<Algorithm*> _distinctAlgorithms;
+	std::vector<bool> _agentsInTrial;
+	std::atomic<bool> _runTrial{true};
+	std::atomic<bool> _paused{false};
+	std::atomic<bool> _converged{false};
+	QLLib::Utils::Budget _budget;
+	std::atomic<bool> _budgetExhausted{false};
+	int64_t _runStartSteps = 0;
+	int64_t _runStartTrials = 0;
+	bool _hasDeadline = false;
+	std::chrono::steady_clock::time_point _deadline;
+	std::atomic<bool> _running{false};
+	// set whenever the simulation must leave its inner loop (stop, pause or a posted command)
+	std::atomic<bool> _interrupt{false};
+	std::mutex _controlMutex;
+	std::condition_variable _controlCv;
+	std::vector<std::function<void()>> _commands;
+	std::thread _worker;
+	std::atomic<int64_t> _progressTrials{0};
+	std::atomic<int64_t> _progressSteps{0};
+	std::atomic<int> _progressStepsPerTrial{0};
+	std::atomic<double> _progressRewardsPerTrial{0.0};
+	int _stepsPerTrial = 0;
+	int64_t _totalSteps = 0;
+	double _rewardsPerTrial = 0.0;
+	int64_t _finishedTrials = 0;
+	std::vector<std::function<void(const QLLib::Utils::Stats&)>> _listeners;
+	// the sinks are declared first so they're destroyed after the notifiers that write to them
+	std::vector<std::unique_ptr<QLLib::QLMetricsSink>> _sinks;
+	std::vector<std::unique_ptr<QLLib::QLNotifier>> _notifiers;
+	std::vector<std::function<bool(const QLLib::Utils::Stats&)>> _criteria;
+};
+
+/*
+ * QL Class - Controls simulation and event loop
+ * This is the general-purpose simulation: it works with any QLProblem and QLAlgorithm through their virtual methods
+ */
+class QL : public BasicQL<QLLib::QLProblem, QLLib::QLAlgorithm> {
+public:
+	/*
+	 * The constructor initializes the QLProblem
+	 * \param p An instance of a QLProblem
+	 */
+	QL(QLLib::QLProblem *p) : BasicQL<QLLib::QLProblem, QLLib::QLAlgorithm>(p) {};
+
+	virtual ~QL() {};
+};
+
+} /* namespace QLLib */
+
+#endif /* QL_H_ */
@@ -1,66 +1,192 @@
-/*
- * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *     http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- *
- * QLAction.h
- *
- *  Created on: Dec 15, 2015
- *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
- */
-
-#ifndef QLACTION_H_
-#define QLACTION_H_
-
-#include <functional>
-
-namespace QLLib {
-
-/*
- * QLAction Class
- * This class represents an action that the agent can perform
- * You can inherit from this class and create your own actions as you like
- */
-class QLAction {
-public:
-	/*
-	 * QLAction Constructor
-	 * \param actionName The name that uniquely identifies the action
-	 * \param actionFunction The lambda that will be called when the action is performed
-	 */
-	QLAction(std::string actionName, std::function<void(QLLib::QLState *state)> actionFunction) : _name(actionName), _action(actionFunction) {};
-
-	virtual ~QLAction() {};
-
-	/*
-	 * Returns the action's printable name
-	 */
-	std::string getName() const {
-		return _name;
-	};
-
-	/*
-	 * Performs the action by running the associated lambda function
-	 * \param s The state the agent is currently in
-	 */
-	void performAction(QLLib::QLState *s) {
-		_action(s);
-	};
-private:
-	std::string _name;
-	std::function<void(QLLib::QLState *state)> _action;
-};
-
-} /* namespace QLLib */
-
-#endif /* QLACTION_H_ */
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLAction.h
+ *
+ *  Created on: Dec 15, 2015
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLACTION_H_
+#define QLACTION_H_
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace QLLib {
+
+class QLState;
+
+/*
+ * QLActionFunction Class
+ * A copyable callable with inline storage, used to hold the lambda of an action.
+ * Callables of up to QLActionFunction::Capacity bytes (i.e. lambdas capturing 'this' and a few pointers or ints)
+ * are stored inside the object itself, so creating, copying and calling the action function never allocates.
+ * Larger callables (i.e. a std::function on some standard libraries) are copied to the heap instead.
+ */
+class QLActionFunction {
+public:
+	static const size_t Capacity = 4 * sizeof(void*);
+
+	/*
+	 * QLActionFunction Constructor - creates an empty function
+	 */
+	QLActionFunction() : _invoke(nullptr), _manage(nullptr) {};
+
+	QLActionFunction(std::nullptr_t) : _invoke(nullptr), _manage(nullptr) {};
+
+	/*
+	 * QLActionFunction Constructor
+	 * \param f The callable (lambda, function pointer, ...) taking a QLState pointer
+	 */
+	template<class F, class = typename std::enable_if<!std::is_same<typename std::decay<F>::type, QLActionFunction>::value>::type>
+	QLActionFunction(F &&f) {
+		typedef typename std::decay<F>::type Functor;
+		typedef typename std::conditional<(sizeof(Functor) <= Capacity), Functor, HeapFunctor<Functor>>::type Stored;
+		static_assert(alignof(Functor) <= alignof(Storage), "The action's lambda is over-aligned");
+		new (&_storage) Stored(std::forward<F>(f));
+		_invoke = &invoke<Stored>;
+		_manage = &manage<Stored>;
+	};
+
+	QLActionFunction(const QLActionFunction &other) : _invoke(other._invoke), _manage(other._manage) {
+		if(_manage != nullptr) _manage(&_storage, &other._storage);
+	};
+
+	QLActionFunction& operator=(const QLActionFunction &other) {
+		if(this != &other) {
+			reset();
+			_invoke = other._invoke;
+			_manage = other._manage;
+			if(_manage != nullptr) _manage(&_storage, &other._storage);
+		}
+		return *this;
+	};
+
+	~QLActionFunction() {
+		reset();
+	};
+
+	/*
+	 * Calls the stored callable
+	 * \param s The state the agent is currently in
+	 */
+	void operator()(QLLib::QLState *s) const {
+		_invoke(&_storage, s);
+	};
+
+	explicit operator bool() const {
+		return _invoke != nullptr;
+	};
+private:
+	typedef typename std::aligned_storage<Capacity>::type Storage;
+	typedef void (*InvokeFunction)(void *storage, QLLib::QLState *s);
+	// Copy-constructs 'source' into 'destination', or destroys 'destination' when 'source' is null
+	typedef void (*ManageFunction)(void *destination, const void *source);
+
+	// Holds a callable that doesn't fit the inline storage
+	template<class Functor>
+	struct HeapFunctor {
+		template<class F>
+		explicit HeapFunctor(F &&f) : _f(new Functor(std::forward<F>(f))) {};
+
+		HeapFunctor(const HeapFunctor &other) : _f(new Functor(*other._f)) {};
+
+		HeapFunctor& operator=(const HeapFunctor&) = delete;
+
+		~HeapFunctor() {
+			delete _f;
+		};
+
+		void operator()(QLLib::QLState *s) const {
+			(*_f)(s);
+		};
+
+		Functor *_f;
+	};
+
+	template<class Functor>
+	static void invoke(void *storage, QLLib::QLState *s) {
+		(*static_cast<Functor*>(storage))(s);
+	};
+
+	template<class Functor>
+	static void manage(void *destination, const void *source) {
+		if(source != nullptr) new (destination) Functor(*static_cast<const Functor*>(source));
+		else static_cast<Functor*>(destination)->~Functor();
+	};
+
+	void reset() {
+		if(_manage != nullptr) _manage(&_storage, nullptr);
+		_invoke = nullptr;
+		_manage = nullptr;
+	};
+
+	mutable Storage _storage;
+	InvokeFunction _invoke;
+	ManageFunction _manage;
+};
+
+/*
+ * QLAction Class
+ * This class represents an action that the agent can perform
+ * You can inherit from this class and create your own actions as you like
+ */
+class QLAction {
+	friend class QLProblem;
+public:
+	/*
+	 * QLAction Constructor
+	 * \param actionName The name that uniquely identifies the action
+	 * \param actionFunction The lambda that will be called when the action is performed
+	 */
+	QLAction(std::string actionName, QLLib::QLActionFunction actionFunction) : _name(actionName), _action(actionFunction) {};
+
+	virtual ~QLAction() {};
+
+	/*
+	 * Returns the action's printable name
+	 */
+	const std::string& getName() const {
+		return _name;
+	};
+
+	/*
+	 * Returns the action's index in the problem (the order in which it was added), or -1 if it wasn't added to a problem
+	 */
+	int getId() const {
+		return _id;
+	};
+
+	/*
+	 * Performs the action by running the associated lambda function
+	 * This never allocates or copies the lambda's captured state
+	 * \param s The state the agent is currently in
+	 */
+	void performAction(QLLib::QLState *s) {
+		_action(s);
+	};
+private:
+	std::string _name;
+	QLLib::QLActionFunction _action;
+	int _id = -1;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLACTION_H_ */
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLActionMask.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLACTIONMASK_H_
+#define QLACTIONMASK_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace QLLib {
+
+/*
+ * QLActionMask Class
+ * The QLActionMask class stores the valid actions of every state in compressed sparse row (CSR) form:
+ * the ids of the valid actions of all states, one state after the other, and the offset of each state's ids.
+ * That's 2 bytes per valid action and 4 per state, however many actions the problem has.
+ * States are added in the order of their ids (see QLProblem::setActionMasking())
+ */
+class QLActionMask {
+public:
+	/*
+	 * QLActionMask Constructor - creates a mask without states
+	 */
+	QLActionMask() : _offsets(1, 0) {};
+
+	virtual ~QLActionMask() {};
+
+	/*
+	 * Adds the valid actions of the next state
+	 * \param actions The ids of the valid actions, in increasing order
+	 * \param count The number of valid actions (0 if the state is terminal)
+	 */
+	void addState(const int actions[], int count) {
+		for(int i = 0; i < count; i++) {
+			if((actions[i] < 0) || (actions[i] > 65535)) {
+				throw std::out_of_range("[ERROR] Action masks need action ids between 0 and 65535");
+			}
+			_actions.push_back(static_cast<uint16_t>(actions[i]));
+		}
+		_offsets.push_back(_actions.size());
+	};
+
+	/*
+	 * Returns the number of valid actions of a state, and their ids
+	 * \param stateId The id of the state
+	 * \param actions Output: a pointer to the ids of the valid actions
+	 */
+	int getActions(int stateId, const uint16_t *&actions) const {
+		if((stateId < 0) || (static_cast<size_t>(stateId) + 1 >= _offsets.size())) {
+			throw std::out_of_range("[ERROR] The state isn't part of the action mask");
+		}
+		uint32_t begin = _offsets[stateId];
+		actions = _actions.data() + begin;
+		return _offsets[stateId + 1] - begin;
+	};
+
+	/*
+	 * Returns the largest Q-value of the valid actions of a state, or 0 if the state doesn't have any (a terminal state)
+	 * \param stateId The id of the state
+	 * \param Q The Q-values of all actions of the state
+	 */
+	template<class T>
+	double max(int stateId, const T Q[]) const {
+		const uint16_t *actions;
+		int count = getActions(stateId, actions);
+		if(count == 0) return 0.0;
+		T maxQ = Q[actions[0]];
+		for(int i = 1; i < count; i++) {
+			if(maxQ < Q[actions[i]]) maxQ = Q[actions[i]];
+		}
+		return maxQ;
+	};
+
+	/*
+	 * Returns the number of states in the mask
+	 */
+	size_t getStateCount() const {
+		return _offsets.size() - 1;
+	};
+
+	/*
+	 * Returns the number of bytes allocated for the mask
+	 */
+	size_t getMemoryUsage() const {
+		return _offsets.capacity() * sizeof(uint32_t) + _actions.capacity() * sizeof(uint16_t);
+	};
+private:
+	std::vector<uint32_t> _offsets;
+	std::vector<uint16_t> _actions;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLACTIONMASK_H_ */
@@ -1,286 +1,1039 @@
-/*
- * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *     http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- *
- * QLAlgorithm.h
- *
- *  Created on: Dec 16, 2015
- *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
- */
-
-#ifndef QLALGORITHM_H_
-#define QLALGORITHM_H_
-
-#include "QLPolicy.h"
-#include "QLLookupTable.h"
-
-namespace QLLib {
-
-/*
- * QLAlgorithm Class
- * The QLAlgorithm class is an abstract class that represents the base of an algorithm.
- * All algorithms must inherit from this class
- */
-class QLAlgorithm {
-public:
-	/*
-	 * QLAlgorithm Constructor
-	 */
-	QLAlgorithm(double initialQ) : _initialQ(initialQ) {};
-
-	virtual ~QLAlgorithm() {};
-
-	/*
-	 * Initializes the algorithm by passing it all available states and actions
-	 * \param states A vector of QLStates
-	 * \param actions A vector of QLActions
-	 */
-	virtual void init(std::vector<QLLib::QLState*> states, std::vector<QLLib::QLAction*> actions) = 0;
-
-	/*
-	 * Utility method called when an episode starts
-	 * Use this to initialize any episode-specific variables
-	 */
-	virtual void initEpisode() {};
-
-	/*
-	 * Assigns a policy to the algorithm
-	 * \param policy An instance of QLPolicy
-	 */
-	void setPolicy(QLPolicy* policy) {
-		_policy = policy;
-	};
-
-	/*
-	 * Returns a pointer to the algorithm's policy
-	 */
-	QLPolicy* getPolicy() {
-		return _policy;
-	};
-
-	/*
-	 * Performs a step by passing the algorithm the current state.
-	 * This method must be implemented by all algorithms and returns a pointer to the action to perform.
-	 * \param currentState The state the agent is currently in
-	 */
-	virtual QLLib::QLAction* step(QLLib::QLState *currentState) = 0;
-
-	/*
-	 * Updates the Q-value for the given state-action combination.
-	 * This method must be implemented by all algorithms.
-	 * \param previousState An instance of QLState
-	 * \param action An instance of QLAction
-	 * \param r The reward received after the state->action
-	 * \param currentState An instance of QLState
-	 */
-	virtual void updateQ(QLLib::QLState *previousState, QLLib::QLAction *action, double r, QLLib::QLState *currentState) = 0;
-protected:
-	double _initialQ;
-	std::vector<QLLib::QLAction*> _actions;
-private:
-	QLPolicy *_policy = nullptr;
-};
-
-/*
- * QLearningAlgorithm Class
- * The QLearningAlgorithm class implements the Q-learning algorithm
- * (http://www.cs.huji.ac.il/~nir/Papers/DFR1.pdf)
- */
-class QLearningAlgorithm : public QLAlgorithm {
-public:
-	/*
-	 * QLearningAlgorithm Constructor
-	 * \param initialQ The default Q-value for all state-action combinations
-	 */
-	QLearningAlgorithm(double initialQ, double alpha, double gamma) : QLAlgorithm(initialQ), _alpha(alpha), _gamma(gamma) {};
-
-	virtual ~QLearningAlgorithm() {};
-
-	/*
-	 * Initializes the Q-learning algorithm by setting the default value for all state-action combinations in the lookup table
-	 * \param states A vector of all available states
-	 * \param actions A vector of all available actions
-	 */
-	virtual void init(std::vector<QLLib::QLState*> states, std::vector<QLLib::QLAction*> actions) {
-		_actions = actions;
-		for(auto i : states) {
-			for(auto j : actions) {
-				_table.setStateAndAction(*i, *j, _initialQ);
-			}
-		}
-	};
-
-	/*
-	 * Utility method called when an episode starts
-	 */
-	virtual void initEpisode() {
-		//
-	}
-
-	/*
-	 * Performs a step by passing the algorithm the current state.
-	 * \param currentState The state the agent is currently in
-	 */
-	virtual QLLib::QLAction* step(QLLib::QLState *currentState) {
-		// If no policy has been provided to the algorithm, use NormalPolicy
-		if(getPolicy() == nullptr) {
-			QLLib::QLPolicy *normalPolicy = new QLLib::NormalPolicy();
-			setPolicy(normalPolicy);
-			std::cout << "[WARNING] No policy specified for QLearningAlgorithm, defaulting to NormalPolicy" << std::endl;
-		}
-		// allocate space for all actions
-		double q[_actions.size()];
-		// load Q-value for all actions
-		for(size_t i=0;i<_actions.size();i++) {
-			q[i] = _table.lookupStateAndAction(*currentState, *_actions[i]);
-		}
-		// return the best action based on the algorithm's policy
-		return _actions[getPolicy()->sampleAction(q, _actions.size())];
-	};
-
-	/*
-	 * Updates the Q-value for the given state-action combination.
-	 * \param previousState An instance of QLState
-	 * \param action An instance of QLAction
-	 * \param r The reward received after the state->action
-	 * \param currentState An instance of QLState
-	 *
-	 * Q = Q(S,A) + alpha * (R + gamma * maxQ(S',A) - Q(S,A))
-	 */
-	virtual void updateQ(QLLib::QLState *previousState, QLLib::QLAction *action, double r, QLLib::QLState *currentState) {
-		double oldQ = _table.lookupStateAndAction(*previousState, *action);
-		double maxQ = getMaxQ(currentState);
-		double newQ = oldQ + _alpha * (r + (_gamma * maxQ) - oldQ);
-		_table.setStateAndAction(*previousState, *action, newQ);
-	};
-private:
-	/*
-	 * Finds max Q value for the given state
-	 * \param state An instance of QLState
-	 */
-	double getMaxQ(QLLib::QLState *state) {
-		// allocate space for all actions
-		double q[_actions.size()];
-		// load Q for all actions
-		for(size_t i=0;i<_actions.size();i++) {
-			q[i] = _table.lookupStateAndAction(*state, *_actions[i]);
-		}
-		// find max Q
-		// TODO: Fix this, as it's slightly biased when two or more values are equal
-		// FIX: Save all MAX indices in array, generate random int between 0 and array lenght-1 and return q[array[random]]
-		int maxIndex = 0;
-		for (size_t index = maxIndex; index < _actions.size(); index++) {
-			if (q[maxIndex] < q[index]) {
-				maxIndex = index;
-			}
-		}
-		return q[maxIndex];
-	};
-
-	QLLookupTable _table;
-	double _alpha;
-	double _gamma;
-};
-
-/*
- * SarsaAlgorithm Class
- * The SarsaAlgorithm class implements the Sarsa On-policy TD control algorithm
- * (http://www.cse.unsw.edu.au/~cs9417ml/RL1/algorithms.html)
- */
-class SarsaAlgorithm: public QLAlgorithm {
-public:
-	/*
-	 * SarsaAlgorithm Constructor
-	 * \param initialQ The default Q-value for all state-action combinations
-	 */
-	SarsaAlgorithm(double initialQ, double alpha, double gamma) : QLAlgorithm(initialQ), _alpha(alpha), _gamma(gamma) {
-		_s1 = nullptr;
-		_a1 = nullptr;
-		_s2 = nullptr;
-		_a2 = nullptr;
-	};
-
-	/*
-	 * Initializes the Sarsa algorithm by setting the default value for all state-action combinations in the lookup table
-	 * \param states A vector of all available states
-	 * \param actions A vector of all available actions
-	 */
-	virtual void init(std::vector<QLLib::QLState*> states, std::vector<QLLib::QLAction*> actions) {
-		_actions = actions;
-		for (auto i : states) {
-			for (auto j : actions) {
-				_table.setStateAndAction(*i, *j, _initialQ);
-			}
-		}
-	};
-
-	/*
-	 * Performs a step by passing the algorithm the current state.
-	 * \param currentState The state the agent is currently in
-	 */
-	virtual QLLib::QLAction* step(QLLib::QLState *currentState) {
-		// If no policy has been provided to the algorithm, use NormalPolicy
-		if (getPolicy() == nullptr) {
-			QLLib::QLPolicy *normalPolicy = new QLLib::NormalPolicy();
-			setPolicy(normalPolicy);
-			std::cout << "[WARNING] No policy specified for QLearningAlgorithm, defaulting to NormalPolicy" << std::endl;
-		}
-		// allocate space for all actions
-		double q[_actions.size()];
-		// load Q-value for all actions
-		for (size_t i = 0; i < _actions.size(); i++) {
-			q[i] = _table.lookupStateAndAction(*currentState, *_actions[i]);
-		}
-		// return the best action based on the algorithm's policy
-		return _actions[getPolicy()->sampleAction(q, _actions.size())];
-	};
-
-	/*
-	 * Updates the Q-value for the given state-action combination.
-	 * \param previousState An instance of QLState
-	 * \param action An instance of QLAction
-	 * \param r The reward received after the state->action
-	 * \param currentState An instance of QLState
-	 *
-	 * Q = Q(S1,A1) + alpha * [R + gamma * Q(S2,A2) - Q(S,A)]
-	 */
-	virtual void updateQ(QLLib::QLState *previousState, QLLib::QLAction *action, double r, QLLib::QLState *currentState) {
-		_s1 = _s2;
-		_a1 = _a2;
-		_s2 = previousState;
-		_a2 = action;
-		// If the agent hasn't performed two actions yet, _s1 and _a1 will be null
-		// In this case, simply return and leave the default Q-value
-		if((_s1 == nullptr) || (_a1 == nullptr)) {
-			return;
-		}
-		double oldQ = _table.lookupStateAndAction(*_s1, *_a1);
-		double currentQ = _table.lookupStateAndAction(*_s2, *_a2);
-		double newQ = oldQ + _alpha * (r + (_gamma * currentQ) - oldQ);
-		_table.setStateAndAction(*_s1, *_a1, newQ);
-	};
-
-private:
-	QLLookupTable _table;
-	double _alpha;
-	double _gamma;
-	QLState *_s1;
-	QLAction *_a1;
-	QLState *_s2;
-	QLAction *_a2;
-};
-
-} /* namespace QLLib */
-
-#endif /* QLALGORITHM_H_ */
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLAlgorithm.h
+ *
+ *  Created on: Dec 16, 2015
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLALGORITHM_H_
+#define QLALGORITHM_H_
+
+#include <cmath>
+#include <memory>
+#include "QLPolicy.h"
+#include "QLLookupTable.h"
+#include "QLCompactTable.h"
+#include "QLSchedule.h"
+#include "QLActionMask.h"
+
+namespace QLLib {
+
+/*
+ * QLAlgorithm Class
+ * The QLAlgorithm class is an abstract class that represents the base of an algorithm.
+ * All algorithms must inherit from this class
+ */
+class QLAlgorithm {
+public:
+	/*
+	 * QLAlgorithm Constructor
+	 */
+	QLAlgorithm(double initialQ) : _initialQ(initialQ) {};
+
+	virtual ~QLAlgorithm() {};
+
+	/*
+	 * Initializes the algorithm by passing it all available states and actions
+	 * \param states A vector of QLStates
+	 * \param actions A vector of QLActions
+	 */
+	virtual void init(const std::vector<QLLib::QLState*> &states, const std::vector<QLLib::QLAction*> &actions) = 0;
+
+	/*
+	 * Utility method called when an episode starts
+	 * Use this to initialize any episode-specific variables
+	 */
+	virtual void initEpisode() {};
+
+	/*
+	 * Utility method called when an episode ends, after the last update
+	 * An episode is truncated when the simulation stopped it before the agent reached the end (see QLLib::Utils::Budget):
+	 * its last state isn't terminal, so its last update went through updateQ() and bootstraps from that state,
+	 * while an episode that wasn't truncated ended with updateQTerminal()
+	 * \param truncated True if the episode was truncated
+	 */
+	virtual void endEpisode(bool /* truncated */) {};
+
+	/*
+	 * Tells the algorithm which agent the following calls to initEpisode(), step() and updateQ() belong to,
+	 * when several agents share the algorithm (see QLProblem::addAgent()).
+	 * Algorithms that remember the agent's past steps (i.e. Sarsa) must keep them per agent
+	 * \param agent The index of the agent
+	 */
+	virtual void selectAgent(int agent) {};
+
+	/*
+	 * Sets the learning rate
+	 * Algorithms without a learning rate ignore it
+	 */
+	virtual void setAlpha(double alpha) {};
+
+	/*
+	 * Sets the discount factor
+	 * Algorithms without a discount factor ignore it
+	 */
+	virtual void setGamma(double gamma) {};
+
+	/*
+	 * Makes the learning rate follow a schedule (i.e. decay over time)
+	 * The algorithm takes ownership of the schedule
+	 * \param schedule An instance of QLSchedule
+	 */
+	void setAlphaSchedule(QLLib::QLSchedule *schedule) {
+		_alphaSchedule.reset(schedule);
+	};
+
+	/*
+	 * Makes the epsilon of the algorithm's EpsilonGreedyPolicy follow a schedule
+	 * The algorithm takes ownership of the schedule
+	 * \param schedule An instance of QLSchedule
+	 */
+	void setEpsilonSchedule(QLLib::QLSchedule *schedule) {
+		_epsilonSchedule.reset(schedule);
+	};
+
+	/*
+	 * Makes the temperature of the algorithm's SoftmaxPolicy follow a schedule
+	 * The algorithm takes ownership of the schedule
+	 * \param schedule An instance of QLSchedule
+	 */
+	void setTemperatureSchedule(QLLib::QLSchedule *schedule) {
+		_temperatureSchedule.reset(schedule);
+	};
+
+	/*
+	 * Returns true if any of the algorithm's schedules counts time in the given unit
+	 */
+	bool hasSchedules(QLLib::QLSchedule::Unit unit) const {
+		return ((_alphaSchedule != nullptr) && (_alphaSchedule->getUnit() == unit)) ||
+				((_epsilonSchedule != nullptr) && (_epsilonSchedule->getUnit() == unit)) ||
+				((_temperatureSchedule != nullptr) && (_temperatureSchedule->getUnit() == unit));
+	};
+
+	/*
+	 * Sets the scheduled parameters to their value at time n. Called by the simulation
+	 * \param unit Only the schedules that count time in this unit are updated
+	 * \param n The number of completed trials or steps
+	 */
+	void updateSchedules(QLLib::QLSchedule::Unit unit, long n) {
+		if((_alphaSchedule != nullptr) && (_alphaSchedule->getUnit() == unit)) {
+			setAlpha(_alphaSchedule->value(n));
+		}
+		if(_policy != _scheduledPolicy) {
+			// resolve the policy's type once, not on every step
+			_scheduledPolicy = _policy;
+			_epsilonPolicy = dynamic_cast<QLLib::EpsilonGreedyPolicy*>(_policy);
+			_softmaxPolicy = dynamic_cast<QLLib::SoftmaxPolicy*>(_policy);
+		}
+		if((_epsilonSchedule != nullptr) && (_epsilonPolicy != nullptr) && (_epsilonSchedule->getUnit() == unit)) {
+			_epsilonPolicy->setEpsilon(_epsilonSchedule->value(n));
+		}
+		if((_temperatureSchedule != nullptr) && (_softmaxPolicy != nullptr) && (_temperatureSchedule->getUnit() == unit)) {
+			_softmaxPolicy->setTemperature(_temperatureSchedule->value(n));
+		}
+	};
+
+	/*
+	 * Counts how many times each state-action combination is updated (see getVisitCounts())
+	 * Call this before the simulation starts
+	 */
+	void enableVisitCounts() {
+		_countVisits = true;
+	};
+
+	/*
+	 * Uses a count-based learning rate: each update of Q(s,a) uses alpha = 1/N(s,a),
+	 * where N(s,a) is the number of times the state-action combination was updated.
+	 * This replaces the algorithm's alpha (and its schedule) and enables visit counts
+	 * \param countBased True to use the count-based learning rate
+	 */
+	void setCountBasedAlpha(bool countBased) {
+		_countBasedAlpha = countBased;
+		if(countBased) _countVisits = true;
+	};
+
+	/*
+	 * Returns the visit counts of all state-action combinations (empty if they aren't enabled)
+	 */
+	QLLib::QLVisitTable& getVisitCounts() {
+		return _visits;
+	};
+
+	/*
+	 * Returns how much the Q-values changed since the last call to resetConvergence()
+	 */
+	const QLLib::Utils::Convergence& getConvergence() const {
+		return _convergence;
+	};
+
+	/*
+	 * Clears the accumulated changes of the Q-values
+	 */
+	void resetConvergence() {
+		_convergence = QLLib::Utils::Convergence();
+	};
+
+	/*
+	 * Counts the updates that change the greedy action of a state.
+	 * This costs an extra pass over the state's Q-values for every update, so it's disabled by default
+	 * \param track True to count policy changes
+	 */
+	void setPolicyChangeTracking(bool track) {
+		_trackPolicyChanges = track;
+	};
+
+	/*
+	 * Assigns a policy to the algorithm
+	 * \param policy An instance of QLPolicy
+	 */
+	void setPolicy(QLPolicy* policy) {
+		_policy = policy;
+	};
+
+	/*
+	 * Returns a pointer to the algorithm's policy
+	 */
+	QLPolicy* getPolicy() {
+		return _policy;
+	};
+
+	/*
+	 * Makes the algorithm only consider the valid actions of each state: the policy chooses among them
+	 * and the largest Q-value of a state is taken over them. Called by the problem (see QLProblem::setActionMasking())
+	 * \param mask The valid actions of every state, owned by the caller (nullptr makes all actions valid)
+	 */
+	void setActionMask(const QLLib::QLActionMask *mask) {
+		_mask = mask;
+	};
+
+	/*
+	 * Returns the algorithm's action mask, or nullptr if all actions are valid
+	 */
+	const QLLib::QLActionMask* getActionMask() const {
+		return _mask;
+	};
+
+	/*
+	 * Performs a step by passing the algorithm the current state.
+	 * This method must be implemented by all algorithms and returns a pointer to the action to perform.
+	 * \param currentState The state the agent is currently in
+	 */
+	virtual QLLib::QLAction* step(QLLib::QLState *currentState) = 0;
+
+	/*
+	 * Updates the Q-value for the given state-action combination.
+	 * This method must be implemented by all algorithms.
+	 * \param previousState An instance of QLState
+	 * \param action An instance of QLAction
+	 * \param r The reward received after the state->action
+	 * \param currentState An instance of QLState
+	 */
+	virtual void updateQ(QLLib::QLState *previousState, QLLib::QLAction *action, double r, QLLib::QLState *currentState) = 0;
+
+	/*
+	 * Updates the Q-value of the transition that ended the episode (step() returned false): the agent reached a terminal state,
+	 * so the update must not bootstrap from it. Truncated episodes end with updateQ() instead (see endEpisode()).
+	 * The default calls updateQ(), for algorithms that don't tell the two apart
+	 * \param previousState An instance of QLState
+	 * \param action An instance of QLAction
+	 * \param r The reward received after the state->action
+	 * \param terminalState The state the episode ended in
+	 */
+	virtual void updateQTerminal(QLLib::QLState *previousState, QLLib::QLAction *action, double r, QLLib::QLState *terminalState) {
+		updateQ(previousState, action, r, terminalState);
+	};
+
+	/*
+	 * Initializes the algorithm for a batched problem (see QLBatch), where states and actions are plain ids
+	 * \param states The number of states
+	 * \param actions The number of actions
+	 */
+	virtual void initBatch(size_t states, size_t actions) {
+		unsupported("initBatch");
+	};
+
+	/*
+	 * Selects the actions of a batch of agents.
+	 * \param states The id of the state each agent is in
+	 * \param actions The id of the action chosen for each agent
+	 * \param n The number of agents
+	 */
+	virtual void stepBatch(const int states[], int actions[], int n) {
+		unsupported("stepBatch");
+	};
+
+	/*
+	 * Updates the Q-values of a batch of agents' transitions.
+	 * \param previousStates The id of the state each agent was in
+	 * \param actions The id of the action each agent performed
+	 * \param rewards The reward each agent received
+	 * \param currentStates The id of the state each agent is in now
+	 * \param nextActions The id of the action each agent will perform next (used by on-policy algorithms)
+	 * \param done True for the agents that reached a terminal state, whose updates don't bootstrap from it
+	 * \param n The number of agents
+	 */
+	virtual void updateQBatch(const int previousStates[], const int actions[], const double rewards[], const int currentStates[], const int nextActions[], const bool done[], int n) {
+		unsupported("updateQBatch");
+	};
+
+	/*
+	 * Returns the number of states in the algorithm's Q-table (see QLFrozenPolicy.h)
+	 */
+	virtual size_t getStateCount() {
+		unsupported("getStateCount", "frozen policies");
+		return 0;
+	};
+
+	/*
+	 * Returns the number of actions in the algorithm's Q-table
+	 */
+	virtual size_t getActionCount() {
+		unsupported("getActionCount", "frozen policies");
+		return 0;
+	};
+
+	/*
+	 * Copies the Q-values of a state, without changing the algorithm.
+	 * Several threads can call it at the same time, but only while the algorithm doesn't learn,
+	 * unless hasConcurrentReads() is true
+	 * \param stateId The id of the state
+	 * \param Q Output: the Q-values of all actions, of size getActionCount()
+	 */
+	virtual void getQValues(int stateId, double Q[]) {
+		unsupported("getQValues", "frozen policies");
+	};
+
+	/*
+	 * Returns true if getQValues() can be called while the algorithm learns on another thread,
+	 * that is if its Q-table has atomic values and never grows (see Utils::ConcurrentReads)
+	 */
+	virtual bool hasConcurrentReads() {
+		return false;
+	};
+
+	/*
+	 * Allocates the storage for 'states' states, so states created on demand don't reallocate the Q-table
+	 * and the visit counts. Called after init() when the problem declares its expected counts
+	 * \param states The number of states expected
+	 */
+	virtual void reserve(size_t states) {
+		if(_countVisits) _visits.reserve(states);
+	};
+
+	/*
+	 * Returns the bytes used by the algorithm's Q-table and visit counts
+	 */
+	virtual QLLib::Utils::MemoryReport getMemoryUsage() {
+		QLLib::Utils::MemoryReport report;
+		report.visits = _visits.getMemoryUsage();
+		return report;
+	};
+protected:
+	/*
+	 * Makes sure the algorithm has a policy of type Policy.
+	 * If no policy has been provided to the algorithm, NormalPolicy is used
+	 */
+	template<class Policy>
+	void initPolicy() {
+		if(_policy == nullptr) {
+			_policy = new QLLib::NormalPolicy();
+			std::cout << "[WARNING] No policy specified for the algorithm, defaulting to NormalPolicy" << std::endl;
+		}
+		if(dynamic_cast<Policy*>(_policy) == nullptr) {
+			std::cout << "[ERROR] The algorithm's policy doesn't match the policy type of the algorithm" << std::endl;
+			exit(1);
+		}
+		if(!QLLib::Utils::isStaticType<Policy>(_policy)) {
+			std::cout << "[ERROR] The algorithm's policy is a subclass of the policy type of the algorithm, its overrides wouldn't be called: use the subclass as the policy type" << std::endl;
+			exit(1);
+		}
+		_policyUsesCounts = _policy->usesVisitCounts();
+		if(_policyUsesCounts) enableVisitCounts();
+	};
+
+	/*
+	 * Applies the algorithm's policy to the provided Q-values.
+	 * When Policy is a concrete class, the call is bound at compile time and can be inlined
+	 * \param Q An array of Q-values (doubles or floats)
+	 * \param count The size of Q
+	 */
+	template<class Policy, class T>
+	int samplePolicy(T Q[], int count) {
+		return samplePolicy<Policy>(Q, count, QLLib::Utils::IsStatic<Policy>());
+	};
+
+	/*
+	 * Applies the algorithm's policy to the Q-values of a state, passing it the state's visit counts if it uses them
+	 * \param stateId The id of the state
+	 * \param Q The state's Q-values
+	 * \param count The size of Q
+	 */
+	template<class Policy, class T>
+	int samplePolicy(int stateId, T Q[], int count) {
+		if(_policyUsesCounts) {
+			return samplePolicy<Policy>(Q, _visits.getRow(stateId), count, QLLib::Utils::IsStatic<Policy>());
+		}
+		return samplePolicy<Policy>(Q, count, QLLib::Utils::IsStatic<Policy>());
+	};
+
+	/*
+	 * Applies the algorithm's policy to the valid actions of a state (see setActionMask()) and returns the chosen action.
+	 * The policy only sees the Q-values (and visit counts) of the valid actions
+	 * \param stateId The id of the state
+	 * \param Q The state's Q-values, for all actions
+	 * \param count The size of Q
+	 */
+	template<class Policy, class T>
+	int sampleValidAction(int stateId, T Q[], int count) {
+		if(_mask == nullptr) return samplePolicy<Policy>(stateId, Q, count);
+		const uint16_t *valid;
+		int n = _mask->getActions(stateId, valid);
+		if(n == 0) {
+			throw std::logic_error("[ERROR] The agent is in a state without valid actions, step() must end the trial there");
+		}
+		std::vector<T> &q = maskedRow(static_cast<T*>(nullptr));
+		q.resize(n);
+		for(int i = 0; i < n; i++) q[i] = Q[valid[i]];
+		if(_policyUsesCounts) {
+			const uint32_t *counts = _visits.getRow(stateId);
+			_maskedCounts.resize(n);
+			for(int i = 0; i < n; i++) _maskedCounts[i] = counts[valid[i]];
+			return valid[samplePolicy<Policy>(&q[0], &_maskedCounts[0], n, QLLib::Utils::IsStatic<Policy>())];
+		}
+		return valid[samplePolicy<Policy>(&q[0], n, QLLib::Utils::IsStatic<Policy>())];
+	};
+
+	/*
+	 * Returns the largest Q-value of the valid actions of a state (0 for a state without valid actions)
+	 * \param table The algorithm's Q-table
+	 * \param stateId The id of the state
+	 */
+	template<class Table>
+	double maxValidQ(Table &table, int stateId) {
+		if(_mask == nullptr) return table.max(stateId);
+		return _mask->max(stateId, loadRow(table, stateId));
+	};
+
+	/*
+	 * Selects the actions of a batch of agents with the algorithm's policy
+	 * \param table The algorithm's Q-table
+	 * \param states The id of the state each agent is in
+	 * \param actions The id of the action chosen for each agent
+	 * \param n The number of agents
+	 */
+	template<class Policy, class Table>
+	void sampleBatch(Table &table, const int states[], int actions[], int n) {
+		if(n <= 0) return;
+		// create the rows of unseen states first, so the row pointers stay valid
+		int maxState = states[0];
+		for(int i = 1; i < n; i++) {
+			if(states[i] > maxState) maxState = states[i];
+		}
+		table.get(maxState, 0);
+		size_t count = table.getActionCount();
+		if(Table::copiesRows) _batchScratch.resize(n * count);
+		std::vector<typename Table::Value*> &rows = rowBuffer(static_cast<typename Table::Value*>(nullptr));
+		rows.resize(n);
+		for(int i = 0; i < n; i++) {
+			rows[i] = table.row(states[i], Table::copiesRows ? &_batchScratch[i * count] : nullptr);
+		}
+		if(_mask != nullptr) {
+			for(int i = 0; i < n; i++) actions[i] = sampleValidAction<Policy>(states[i], rows[i], count);
+			return;
+		}
+		if(_policyUsesCounts) {
+			_visits.getRow(maxState);
+			for(int i = 0; i < n; i++) {
+				actions[i] = samplePolicy<Policy>(rows[i], _visits.getRow(states[i]), table.getActionCount(), QLLib::Utils::IsStatic<Policy>());
+			}
+			return;
+		}
+		samplePolicyBatch<Policy>(&rows[0], table.getActionCount(), n, actions, QLLib::Utils::IsStatic<Policy>());
+	};
+
+	/*
+	 * Initializes the visit counts, if they are enabled
+	 * \param states The number of states
+	 * \param actions The number of actions
+	 */
+	void initVisitCounts(size_t states, size_t actions) {
+		if(_countVisits) _visits.init(states, actions);
+	};
+
+	/*
+	 * Returns the learning rate for an update of Q(s,a), counting the visit if visit counts are enabled
+	 * \param stateId The id of the updated state
+	 * \param actionId The id of the updated action
+	 * \param alpha The algorithm's learning rate
+	 */
+	double learningRate(int stateId, int actionId, double alpha) {
+		if(!_countVisits) return alpha;
+		uint32_t n = _visits.visit(stateId, actionId);
+		return _countBasedAlpha ? 1.0 / n : alpha;
+	};
+
+	/*
+	 * Returns the Q-values of a state as an array of the table's value type (see QLLookupTable.h).
+	 * Tables that store Q-values in another type decode them into a scratch row of doubles owned by the algorithm,
+	 * which is valid until the next call
+	 * \param table The algorithm's Q-table
+	 * \param stateId The id of the state
+	 */
+	template<class Table>
+	typename Table::Value* loadRow(Table &table, int stateId) {
+		if(!Table::copiesRows) return table.row(stateId, nullptr);
+		_scratch.resize(table.getActionCount());
+		return table.row(stateId, &_scratch[0]);
+	};
+
+	/*
+	 * Writes an updated Q-value. Tables shared by several processes (see QLSharedTable.h) add the change instead,
+	 * so concurrent updates of the same value aren't lost
+	 * \param table The algorithm's Q-table
+	 * \param stateId The id of the updated state
+	 * \param actionId The id of the updated action
+	 * \param oldQ The Q-value the update was computed from
+	 * \param newQ The updated Q-value
+	 */
+	template<class Table>
+	void storeQ(Table &table, int stateId, int actionId, double oldQ, double newQ) {
+		storeQ(table, stateId, actionId, oldQ, newQ, std::integral_constant<bool, Table::atomicAdd>());
+	};
+
+	/*
+	 * Records an update of a Q-value in the convergence stats
+	 * \param table The algorithm's Q-table, after the update
+	 * \param stateId The id of the updated state
+	 * \param action The index of the updated action
+	 * \param oldQ The Q-value before the update
+	 * \param newQ The Q-value after the update
+	 */
+	template<class Table>
+	void recordUpdate(Table &table, int stateId, int action, double oldQ, double newQ) {
+		double delta = std::fabs(newQ - oldQ);
+		if(delta > _convergence.maxDeltaQ) _convergence.maxDeltaQ = delta;
+		_convergence.sumDeltaQ += delta;
+		_convergence.updates++;
+		if(_trackPolicyChanges && (delta > 0.0)) {
+			const typename Table::Value *row = loadRow(table, stateId);
+			int count = table.getActionCount();
+			const uint16_t *valid = nullptr;
+			if(_mask != nullptr) count = _mask->getActions(stateId, valid);
+			// find the best of the other (valid) actions, the first one wins ties like in the greedy policies
+			int other = -1;
+			for(int j = 0; j < count; j++) {
+				int i = (valid != nullptr) ? valid[j] : j;
+				if((i != action) && ((other < 0) || (row[other] < row[i]))) other = i;
+			}
+			if(other >= 0) {
+				bool wasGreedy = (oldQ > row[other]) || ((oldQ == row[other]) && (action < other));
+				bool isGreedy = (newQ > row[other]) || ((newQ == row[other]) && (action < other));
+				if(wasGreedy != isGreedy) _convergence.policyChanges++;
+			}
+		}
+	};
+
+	double _initialQ;
+	std::vector<QLLib::QLAction*> _actions;
+private:
+	void unsupported(const std::string &method, const std::string &feature = "batched problems") {
+		std::cout << "[ERROR] The algorithm doesn't implement " << method << "(), it can't be used with " << feature << std::endl;
+		exit(1);
+	};
+
+	template<class Policy, class T>
+	void samplePolicyBatch(T *const rows[], int count, int n, int actions[], std::false_type) {
+		_policy->sampleActions(rows, count, n, actions);
+	};
+
+	template<class Policy, class T>
+	void samplePolicyBatch(T *const rows[], int count, int n, int actions[], std::true_type) {
+		static_cast<Policy*>(_policy)->Policy::sampleActions(rows, count, n, actions);
+	};
+
+	template<class Table>
+	void storeQ(Table &table, int stateId, int actionId, double oldQ, double newQ, std::false_type) {
+		table.set(stateId, actionId, newQ);
+	};
+
+	template<class Table>
+	void storeQ(Table &table, int stateId, int actionId, double oldQ, double newQ, std::true_type) {
+		table.add(stateId, actionId, newQ - oldQ);
+	};
+
+	// the row pointers of a batch, by value type
+	std::vector<double*>& rowBuffer(double*) {
+		return _rows;
+	};
+
+	std::vector<float*>& rowBuffer(float*) {
+		return _floatRows;
+	};
+
+	// the Q-values of a state's valid actions, by value type
+	std::vector<double>& maskedRow(double*) {
+		return _maskedRow;
+	};
+
+	std::vector<float>& maskedRow(float*) {
+		return _maskedFloatRow;
+	};
+
+	std::vector<double*> _rows;
+	std::vector<float*> _floatRows;
+	std::vector<double> _scratch;
+	std::vector<double> _batchScratch;
+	const QLLib::QLActionMask *_mask = nullptr;
+	std::vector<double> _maskedRow;
+	std::vector<float> _maskedFloatRow;
+	std::vector<uint32_t> _maskedCounts;
+
+	template<class Policy, class T>
+	int samplePolicy(T Q[], int count, std::false_type) {
+		return _policy->sampleAction(Q, count);
+	};
+
+	template<class Policy, class T>
+	int samplePolicy(T Q[], int count, std::true_type) {
+		return static_cast<Policy*>(_policy)->Policy::sampleAction(Q, count);
+	};
+
+	template<class Policy, class T>
+	int samplePolicy(T Q[], const uint32_t N[], int count, std::false_type) {
+		return _policy->sampleAction(Q, N, count);
+	};
+
+	template<class Policy, class T>
+	int samplePolicy(T Q[], const uint32_t N[], int count, std::true_type) {
+		return static_cast<Policy*>(_policy)->Policy::sampleAction(Q, N, count);
+	};
+
+	QLPolicy *_policy = nullptr;
+	QLLib::Utils::Convergence _convergence;
+	bool _trackPolicyChanges = false;
+	std::unique_ptr<QLLib::QLSchedule> _alphaSchedule;
+	std::unique_ptr<QLLib::QLSchedule> _epsilonSchedule;
+	std::unique_ptr<QLLib::QLSchedule> _temperatureSchedule;
+	QLPolicy *_scheduledPolicy = nullptr;
+	QLLib::EpsilonGreedyPolicy *_epsilonPolicy = nullptr;
+	QLLib::SoftmaxPolicy *_softmaxPolicy = nullptr;
+	QLLib::QLVisitTable _visits;
+	bool _countVisits = false;
+	bool _countBasedAlpha = false;
+	bool _policyUsesCounts = false;
+};
+
+/*
+ * BasicQLearningAlgorithm Class
+ * The BasicQLearningAlgorithm class implements the Q-learning algorithm
+ * (http://www.cs.huji.ac.il/~nir/Papers/DFR1.pdf)
+ * Policy is the type of the policy used by the algorithm: when it's a concrete policy (i.e. EpsilonGreedyPolicy)
+ * the policy is called without virtual dispatch, so the policy must be exactly of that type (a subclass of it is rejected
+ * when the algorithm is initialized, use the subclass as Policy instead). Use QLearningAlgorithm to accept any policy.
+ * Table is the type of the Q-table: QLLookupTable stores doubles, QLFloatLookupTable stores floats and the tables in
+ * QLCompactTable.h store Q-values in fewer bytes (i.e. BasicQLearningAlgorithm<QLLib::QLPolicy, QLLib::QLFloat16Table>).
+ */
+template<class Policy = QLLib::QLPolicy, class Table = QLLib::QLLookupTable>
+class BasicQLearningAlgorithm : public QLAlgorithm {
+public:
+	/*
+	 * BasicQLearningAlgorithm Constructor
+	 * \param initialQ The default Q-value for all state-action combinations
+	 */
+	BasicQLearningAlgorithm(double initialQ, double alpha, double gamma) : QLAlgorithm(initialQ), _alpha(alpha), _gamma(gamma) {};
+
+	virtual ~BasicQLearningAlgorithm() {};
+
+	/*
+	 * Initializes the Q-learning algorithm by setting the default value for all state-action combinations in the lookup table
+	 * \param states A vector of all available states
+	 * \param actions A vector of all available actions
+	 */
+	virtual void init(const std::vector<QLLib::QLState*> &states, const std::vector<QLLib::QLAction*> &actions) {
+		initPolicy<Policy>();
+		_actions = actions;
+		_table.init(states.size(), actions.size(), _initialQ);
+		initVisitCounts(states.size(), actions.size());
+	};
+
+	/*
+	 * Utility method called when an episode starts
+	 */
+	virtual void initEpisode() {
+		//
+	}
+
+	/*
+	 * Sets the learning rate
+	 */
+	virtual void setAlpha(double alpha) {
+		_alpha = alpha;
+	};
+
+	/*
+	 * Sets the discount factor
+	 */
+	virtual void setGamma(double gamma) {
+		_gamma = gamma;
+	};
+
+	/*
+	 * Performs a step by passing the algorithm the current state.
+	 * \param currentState The state the agent is currently in
+	 */
+	virtual QLLib::QLAction* step(QLLib::QLState *currentState) {
+		// load Q-value for all actions (the state's row in the table)
+		typename Table::Value *q = loadRow(_table, currentState->getId());
+		// return the best action based on the algorithm's policy
+		return _actions[sampleValidAction<Policy>(currentState->getId(), q, _actions.size())];
+	};
+
+	/*
+	 * Updates the Q-value for the given state-action combination.
+	 * \param previousState An instance of QLState
+	 * \param action An instance of QLAction
+	 * \param r The reward received after the state->action
+	 * \param currentState An instance of QLState
+	 *
+	 * Q = Q(S,A) + alpha * (R + gamma * maxQ(S',A) - Q(S,A))
+	 */
+	virtual void updateQ(QLLib::QLState *previousState, QLLib::QLAction *action, double r, QLLib::QLState *currentState) {
+		int s = previousState->getId();
+		int a = action->getId();
+		double maxQ = maxValidQ(_table, currentState->getId());
+		double oldQ = _table.get(s, a);
+		double alpha = learningRate(s, a, _alpha);
+		double newQ = oldQ + alpha * (r + (_gamma * maxQ) - oldQ);
+		storeQ(_table, s, a, oldQ, newQ);
+		recordUpdate(_table, s, a, oldQ, newQ);
+	};
+
+	/*
+	 * Updates the Q-value of the transition that reached a terminal state
+	 *
+	 * Q = Q(S,A) + alpha * (R - Q(S,A))
+	 */
+	virtual void updateQTerminal(QLLib::QLState *previousState, QLLib::QLAction *action, double r, QLLib::QLState *terminalState) {
+		int s = previousState->getId();
+		int a = action->getId();
+		double oldQ = _table.get(s, a);
+		double alpha = learningRate(s, a, _alpha);
+		double newQ = oldQ + alpha * (r - oldQ);
+		storeQ(_table, s, a, oldQ, newQ);
+		recordUpdate(_table, s, a, oldQ, newQ);
+	};
+
+	/*
+	 * Initializes the algorithm for a batched problem
+	 * \param states The number of states
+	 * \param actions The number of actions
+	 */
+	virtual void initBatch(size_t states, size_t actions) {
+		initPolicy<Policy>();
+		_table.init(states, actions, _initialQ);
+		initVisitCounts(states, actions);
+	};
+
+	/*
+	 * Selects the actions of a batch of agents
+	 */
+	virtual void stepBatch(const int states[], int actions[], int n) {
+		sampleBatch<Policy>(_table, states, actions, n);
+	};
+
+	/*
+	 * Updates the Q-values of a batch of agents' transitions (nextActions isn't used by Q-learning)
+	 */
+	virtual void updateQBatch(const int previousStates[], const int actions[], const double rewards[], const int currentStates[], const int nextActions[], const bool done[], int n) {
+		for(int i = 0; i < n; i++) {
+			double maxQ = done[i] ? 0.0 : maxValidQ(_table, currentStates[i]);
+			double oldQ = _table.get(previousStates[i], actions[i]);
+			double alpha = learningRate(previousStates[i], actions[i], _alpha);
+			double newQ = oldQ + alpha * (rewards[i] + (_gamma * maxQ) - oldQ);
+			storeQ(_table, previousStates[i], actions[i], oldQ, newQ);
+			recordUpdate(_table, previousStates[i], actions[i], oldQ, newQ);
+		}
+	};
+
+	virtual size_t getStateCount() {
+		return _table.getStateCount();
+	};
+
+	virtual size_t getActionCount() {
+		return _table.getActionCount();
+	};
+
+	/*
+	 * Copies the Q-values of a state, without changing the table
+	 */
+	virtual void getQValues(int stateId, double Q[]) {
+		_table.copyRow(stateId, Q);
+	};
+
+	virtual bool hasConcurrentReads() {
+		return QLLib::Utils::ConcurrentReads<Table>::value;
+	};
+
+	virtual void reserve(size_t states) {
+		QLAlgorithm::reserve(states);
+		_table.reserve(states);
+	};
+
+	virtual QLLib::Utils::MemoryReport getMemoryUsage() {
+		QLLib::Utils::MemoryReport report = QLAlgorithm::getMemoryUsage();
+		report.table = _table.getMemoryUsage();
+		return report;
+	};
+
+	/*
+	 * Returns the algorithm's Q-table (i.e. to open a QLSharedTable before the problem is initialized)
+	 */
+	Table& getTable() {
+		return _table;
+	};
+private:
+	Table _table;
+	double _alpha;
+	double _gamma;
+};
+
+/*
+ * QLearningAlgorithm
+ * Q-learning with any policy
+ */
+typedef BasicQLearningAlgorithm<> QLearningAlgorithm;
+
+/*
+ * BasicSarsaAlgorithm Class
+ * The BasicSarsaAlgorithm class implements the Sarsa On-policy TD control algorithm
+ * (http://www.cse.unsw.edu.au/~cs9417ml/RL1/algorithms.html)
+ * Policy and Table are the types of the policy and of the Q-table used by the algorithm, see BasicQLearningAlgorithm
+ */
+template<class Policy = QLLib::QLPolicy, class Table = QLLib::QLLookupTable>
+class BasicSarsaAlgorithm: public QLAlgorithm {
+public:
+	/*
+	 * BasicSarsaAlgorithm Constructor
+	 * \param initialQ The default Q-value for all state-action combinations
+	 */
+	BasicSarsaAlgorithm(double initialQ, double alpha, double gamma) : QLAlgorithm(initialQ), _alpha(alpha), _gamma(gamma) {
+		_history.resize(1);
+	};
+
+	/*
+	 * Initializes the Sarsa algorithm by setting the default value for all state-action combinations in the lookup table
+	 * \param states A vector of all available states
+	 * \param actions A vector of all available actions
+	 */
+	virtual void init(const std::vector<QLLib::QLState*> &states, const std::vector<QLLib::QLAction*> &actions) {
+		initPolicy<Policy>();
+		_actions = actions;
+		_table.init(states.size(), actions.size(), _initialQ);
+		initVisitCounts(states.size(), actions.size());
+	};
+
+	/*
+	 * Updates the agent's last transition if the episode was truncated, bootstrapping from an action the policy chooses
+	 * in the last state, and forgets it, so the next episode's first update doesn't use this episode's state-action pairs
+	 */
+	virtual void endEpisode(bool truncated) {
+		History &h = _history[_agent];
+		if(truncated && (h.s != nullptr)) {
+			typename Table::Value *q = loadRow(_table, h.next->getId());
+			int next = sampleValidAction<Policy>(h.next->getId(), q, _actions.size());
+			update(h.s->getId(), h.a->getId(), h.r + _gamma * _table.get(h.next->getId(), next));
+		}
+		h = History();
+	};
+
+	/*
+	 * Selects the agent whose history the following updates use
+	 * \param agent The index of the agent
+	 */
+	virtual void selectAgent(int agent) {
+		if((size_t) agent >= _history.size()) _history.resize(agent + 1);
+		_agent = agent;
+	};
+
+	/*
+	 * Sets the learning rate
+	 */
+	virtual void setAlpha(double alpha) {
+		_alpha = alpha;
+	};
+
+	/*
+	 * Sets the discount factor
+	 */
+	virtual void setGamma(double gamma) {
+		_gamma = gamma;
+	};
+
+	/*
+	 * Performs a step by passing the algorithm the current state.
+	 * \param currentState The state the agent is currently in
+	 */
+	virtual QLLib::QLAction* step(QLLib::QLState *currentState) {
+		// load Q-value for all actions (the state's row in the table)
+		typename Table::Value *q = loadRow(_table, currentState->getId());
+		// return the best action based on the algorithm's policy
+		return _actions[sampleValidAction<Policy>(currentState->getId(), q, _actions.size())];
+	};
+
+	/*
+	 * Updates the Q-value for the given state-action combination.
+	 * A transition is updated one step late, when the action performed after it (A2) is known:
+	 * this call updates the agent's previous transition, and keeps this one for the next call
+	 * \param previousState An instance of QLState
+	 * \param action An instance of QLAction
+	 * \param r The reward received after the state->action
+	 * \param currentState An instance of QLState
+	 *
+	 * Q = Q(S1,A1) + alpha * [R1 + gamma * Q(S2,A2) - Q(S1,A1)]
+	 */
+	virtual void updateQ(QLLib::QLState *previousState, QLLib::QLAction *action, double r, QLLib::QLState *currentState) {
+		History &h = _history[_agent];
+		// On the first step of an episode there's no previous transition, its Q-value is updated on the next step
+		if(h.s != nullptr) {
+			update(h.s->getId(), h.a->getId(), h.r + _gamma * _table.get(previousState->getId(), action->getId()));
+		}
+		h.s = previousState;
+		h.a = action;
+		h.r = r;
+		h.next = currentState;
+	};
+
+	/*
+	 * Updates the agent's previous transition and the transition that reached a terminal state, which doesn't bootstrap
+	 *
+	 * Q = Q(S,A) + alpha * [R - Q(S,A)]
+	 */
+	virtual void updateQTerminal(QLLib::QLState *previousState, QLLib::QLAction *action, double r, QLLib::QLState *terminalState) {
+		History &h = _history[_agent];
+		if(h.s != nullptr) {
+			update(h.s->getId(), h.a->getId(), h.r + _gamma * _table.get(previousState->getId(), action->getId()));
+		}
+		update(previousState->getId(), action->getId(), r);
+		h = History();
+	};
+
+	/*
+	 * Initializes the algorithm for a batched problem
+	 * \param states The number of states
+	 * \param actions The number of actions
+	 */
+	virtual void initBatch(size_t states, size_t actions) {
+		initPolicy<Policy>();
+		_table.init(states, actions, _initialQ);
+		initVisitCounts(states, actions);
+	};
+
+	/*
+	 * Selects the actions of a batch of agents
+	 */
+	virtual void stepBatch(const int states[], int actions[], int n) {
+		sampleBatch<Policy>(_table, states, actions, n);
+	};
+
+	/*
+	 * Updates the Q-values of a batch of agents' transitions
+	 *
+	 * Q = Q(S,A) + alpha * [R + gamma * Q(S',A') - Q(S,A)]
+	 */
+	virtual void updateQBatch(const int previousStates[], const int actions[], const double rewards[], const int currentStates[], const int nextActions[], const bool done[], int n) {
+		for(int i = 0; i < n; i++) {
+			double nextQ = done[i] ? 0.0 : _table.get(currentStates[i], nextActions[i]);
+			double oldQ = _table.get(previousStates[i], actions[i]);
+			double alpha = learningRate(previousStates[i], actions[i], _alpha);
+			double newQ = oldQ + alpha * (rewards[i] + (_gamma * nextQ) - oldQ);
+			storeQ(_table, previousStates[i], actions[i], oldQ, newQ);
+			recordUpdate(_table, previousStates[i], actions[i], oldQ, newQ);
+		}
+	};
+
+	virtual size_t getStateCount() {
+		return _table.getStateCount();
+	};
+
+	virtual size_t getActionCount() {
+		return _table.getActionCount();
+	};
+
+	/*
+	 * Copies the Q-values of a state, without changing the table
+	 */
+	virtual void getQValues(int stateId, double Q[]) {
+		_table.copyRow(stateId, Q);
+	};
+
+	virtual bool hasConcurrentReads() {
+		return QLLib::Utils::ConcurrentReads<Table>::value;
+	};
+
+	virtual void reserve(size_t states) {
+		QLAlgorithm::reserve(states);
+		_table.reserve(states);
+	};
+
+	virtual QLLib::Utils::MemoryReport getMemoryUsage() {
+		QLLib::Utils::MemoryReport report = QLAlgorithm::getMemoryUsage();
+		report.table = _table.getMemoryUsage();
+		return report;
+	};
+
+	/*
+	 * Returns the algorithm's Q-table (i.e. to open a QLSharedTable before the problem is initialized)
+	 */
+	Table& getTable() {
+		return _table;
+	};
+
+private:
+	/*
+	 * Moves Q(s,a) towards the target
+	 */
+	void update(int s, int a, double target) {
+		double oldQ = _table.get(s, a);
+		double alpha = learningRate(s, a, _alpha);
+		double newQ = oldQ + alpha * (target - oldQ);
+		storeQ(_table, s, a, oldQ, newQ);
+		recordUpdate(_table, s, a, oldQ, newQ);
+	};
+
+	Table _table;
+	double _alpha;
+	double _gamma;
+	// The last transition of each agent, which is updated when the agent's next action is known
+	struct History {
+		QLState *s = nullptr;
+		QLAction *a = nullptr;
+		double r = 0.0;
+		QLState *next = nullptr;
+	};
+	std::vector<History> _history;
+	int _agent = 0;
+};
+
+/*
+ * SarsaAlgorithm
+ * Sarsa with any policy
+ */
+typedef BasicSarsaAlgorithm<> SarsaAlgorithm;
+
+} /* namespace QLLib */
+
+#endif /* QLALGORITHM_H_ */
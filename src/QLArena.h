@@ -0,0 +1,156 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLArena.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLARENA_H_
+#define QLARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace QLLib {
+
+/*
+ * QLArena Class
+ * The QLArena class is a region allocator: objects are constructed in place, one after the other,
+ * inside large memory blocks. Creating an object is a pointer bump, objects created one after
+ * the other are neighbours in memory, and all of them are released at once.
+ */
+class QLArena {
+public:
+	/*
+	 * QLArena Constructor
+	 * \param blockSize The size in bytes of each memory block
+	 */
+	QLArena(size_t blockSize = 64 * 1024) : _blockSize(blockSize) {};
+
+	/*
+	 * QLArena Destructor - destroys all objects and frees all blocks
+	 */
+	virtual ~QLArena() {
+		release();
+	};
+
+	/*
+	 * Constructs an object of type T inside the arena
+	 * \param args The arguments passed to T's constructor
+	 */
+	template<class T, class... Args>
+	T* create(Args&&... args) {
+		void *memory = allocate(sizeof(T), alignof(T));
+		T *object = new (memory) T(std::forward<Args>(args)...);
+		Record record;
+		record.object = object;
+		record.destroy = std::is_trivially_destructible<T>::value ? nullptr : &destroy<T>;
+		_objects.push_back(record);
+		return object;
+	};
+
+	/*
+	 * Calls f on every object of the arena, in allocation order
+	 * \param f A callable taking a void pointer to the object
+	 */
+	template<class F>
+	void forEach(F f) const {
+		for(auto &i : _objects) f(i.object);
+	};
+
+	/*
+	 * Destroys all objects (in reverse allocation order) and frees all blocks
+	 */
+	void release() {
+		for(auto i = _objects.rbegin(); i != _objects.rend(); ++i) {
+			if(i->destroy != nullptr) i->destroy(i->object);
+		}
+		for(auto i : _blocks) ::operator delete(i);
+		_objects.clear();
+		_blocks.clear();
+		_current = nullptr;
+		_remaining = 0;
+		_bytesUsed = 0;
+	};
+
+	/*
+	 * Returns the number of objects in the arena
+	 */
+	size_t size() const {
+		return _objects.size();
+	};
+
+	/*
+	 * Returns the number of bytes allocated for blocks
+	 */
+	size_t bytesReserved() const {
+		return _bytesReserved;
+	};
+
+	/*
+	 * Returns the number of bytes used by objects
+	 */
+	size_t bytesUsed() const {
+		return _bytesUsed;
+	};
+private:
+	struct Record {
+		void *object;
+		void (*destroy)(void *object);
+	};
+
+	template<class T>
+	static void destroy(void *object) {
+		static_cast<T*>(object)->~T();
+	};
+
+	void* allocate(size_t size, size_t alignment) {
+		size_t padding = (alignment - (reinterpret_cast<size_t>(_current) % alignment)) % alignment;
+		if((_current == nullptr) || (padding + size > _remaining)) {
+			// Objects bigger than a block get a block of their own
+			size_t blockSize = (size > _blockSize) ? size : _blockSize;
+			_current = static_cast<char*>(::operator new(blockSize));
+			_blocks.push_back(_current);
+			_remaining = blockSize;
+			_bytesReserved += blockSize;
+			padding = 0;
+		}
+		void *memory = _current + padding;
+		_current += padding + size;
+		_remaining -= padding + size;
+		_bytesUsed += size;
+		return memory;
+	};
+
+	QLArena(const QLArena&);
+	QLArena& operator=(const QLArena&);
+
+	size_t _blockSize;
+	char *_current = nullptr;
+	size_t _remaining = 0;
+	size_t _bytesReserved = 0;
+	size_t _bytesUsed = 0;
+	std::vector<char*> _blocks;
+	std::vector<Record> _objects;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLARENA_H_ */
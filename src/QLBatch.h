@@ -0,0 +1,291 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLBatch.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLBATCH_H_
+#define QLBATCH_H_
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "QLUtils.h"
+#include "QLAlgorithm.h"
+
+namespace QLLib {
+
+/*
+ * QLBatchProblem Class
+ * The QLBatchProblem class represents the model of a Q-learning problem that is simulated for
+ * a batch of independent agents at once. States and actions are plain ids (0 to count-1) and
+ * each agent's data is stored in arrays indexed by agent (structure of arrays), so the
+ * environment, the policy and the algorithm each process the whole batch in a single call.
+ * All agents share the algorithm (and so its Q-table).
+ */
+class QLBatchProblem {
+	friend class QLBatch;
+public:
+	/*
+	 * QLBatchProblem Constructor
+	 * \param batchSize The number of agents
+	 */
+	QLBatchProblem(int batchSize) : _batchSize(batchSize) {
+		_algorithm = nullptr;
+	};
+
+	/*
+	 * QLBatchProblem Destructor
+	 */
+	virtual ~QLBatchProblem() {
+		delete _algorithm;
+	};
+
+	/*
+	 * Returns the number of agents
+	 */
+	int getBatchSize() const {
+		return _batchSize;
+	};
+
+	/*
+	 * Returns a pointer to the chosen algorithm
+	 */
+	QLLib::QLAlgorithm* getAlgorithm() {
+		if(_algorithm == nullptr) {
+			_algorithm = new QLLib::QLearningAlgorithm(0.0, 0.2, 0.9);
+			std::cout << "[WARNING] No algorithm specified, defaulting to QLearningAlgorithm" << std::endl;
+		}
+		return _algorithm;
+	};
+
+	/*
+	 * Sets the algorithm for the problem
+	 */
+	void setAlgorithm(QLLib::QLAlgorithm *a) {
+		_algorithm = a;
+	};
+private:
+	void init() {
+		setupAlgorithm();
+		getAlgorithm()->initBatch(getStateCount(), getActionCount());
+	};
+
+	/*
+	 * Returns the number of states (state ids go from 0 to getStateCount()-1)
+	 */
+	virtual size_t getStateCount() = 0;
+
+	/*
+	 * Returns the number of actions (action ids go from 0 to getActionCount()-1)
+	 */
+	virtual size_t getActionCount() = 0;
+
+	virtual void setupAlgorithm() = 0;
+
+	/*
+	 * Starts a new episode for an agent and returns the id of its initial state
+	 * \param agent The index of the agent in the batch
+	 */
+	virtual int resetAgent(int agent) = 0;
+
+	/*
+	 * Steps all agents at once
+	 * \param states The id of the state each agent is in
+	 * \param actions The id of the action each agent performs
+	 * \param nextStates Output: the id of the state each agent moves to
+	 * \param rewards Output: the reward each agent receives
+	 * \param done Output: true for the agents that reached the end of their episode
+	 * \param n The number of agents
+	 */
+	virtual void step(const int states[], const int actions[], int nextStates[], double rewards[], bool done[], int n) = 0;
+
+	int _batchSize;
+	QLLib::QLAlgorithm *_algorithm;
+};
+
+/*
+ * QLBatch Class - Controls the simulation of a batched problem
+ * Every tick selects the actions of all agents, steps the environment and applies all TD updates,
+ * each with a single call. Agents that finish their episode are reset and start a new one.
+ */
+class QLBatch {
+public:
+	/*
+	 * The constructor initializes the QLBatchProblem
+	 * \param p An instance of a QLBatchProblem
+	 */
+	QLBatch(QLLib::QLBatchProblem *p) : _problem(p) {
+		_problem->init();
+		_algorithm = _problem->getAlgorithm();
+		int n = _problem->getBatchSize();
+		_states.resize(n);
+		_actions.resize(n);
+		_nextStates.resize(n);
+		_nextActions.resize(n);
+		_rewards.resize(n);
+		_done.reset(new bool[n]);
+		_stepsPerEpisode.assign(n, 0);
+		_rewardsPerEpisode.assign(n, 0.0);
+		for(int i = 0; i < n; i++) {
+			_states[i] = _problem->resetAgent(i);
+		}
+		_algorithm->stepBatch(&_states[0], &_actions[0], n);
+	};
+
+	virtual ~QLBatch() {};
+
+	/*
+	 * Step all agents 'n' times
+	 * \param n The number of ticks
+	 */
+	void start(long n) {
+		beginRun();
+		for (long i = 1; (i <= n && _runTrial && !_budgetExhausted); i++) {
+			tick();
+		}
+	};
+
+	/*
+	 * Stop the simulation
+	 */
+	void stop() {
+		_runTrial = false;
+	};
+
+	/*
+	 * Limits the steps of each episode, and the steps (of all agents), episodes and time of each run (each call to start()).
+	 * An episode that reaches the step limit is reset and reported as truncated: its last update bootstrapped
+	 * from the state it was in, as it should for a state that isn't terminal.
+	 * When a run limit is reached the run stops after the current tick
+	 * \param budget The limits
+	 */
+	void setBudget(const QLLib::Utils::Budget &budget) {
+		_budget = budget;
+	};
+
+	/*
+	 * Returns true if the last run was stopped because it reached one of its budget's limits
+	 */
+	bool isBudgetExhausted() const {
+		return _budgetExhausted;
+	};
+
+	/*
+	 * Create an event listener that notifies when an agent's episode ends
+	 * \param cb The callback function (lambda) that will be called when an episode ends
+	 */
+	void addEventListener(std::function<void(const QLLib::Utils::Stats&)> cb) {
+		_listeners.push_back(cb);
+	};
+private:
+	/*
+	 * Steps the whole batch once
+	 */
+	void tick() {
+		int n = _problem->getBatchSize();
+		// Set the scheduled parameters, a batch counts as one trial for each finished episode and n steps per tick
+		_algorithm->updateSchedules(QLLib::QLSchedule::PerTrial, _finishedTrials);
+		_algorithm->updateSchedules(QLLib::QLSchedule::PerStep, _totalSteps);
+		// Step the environment for all agents
+		_problem->step(&_states[0], &_actions[0], &_nextStates[0], &_rewards[0], _done.get(), n);
+		// Choose the next actions (Sarsa needs them for the update)...
+		_algorithm->stepBatch(&_nextStates[0], &_nextActions[0], n);
+		// ...and apply all TD updates
+		_algorithm->updateQBatch(&_states[0], &_actions[0], &_rewards[0], &_nextStates[0], &_nextActions[0], _done.get(), n);
+		_totalSteps += n;
+		for(int i = 0; i < n; i++) {
+			_stepsPerEpisode[i]++;
+			_rewardsPerEpisode[i] += _rewards[i];
+			if(_done[i]) {
+				endOfEpisode(i, false);
+			} else if((_budget.maxStepsPerTrial > 0) && (_stepsPerEpisode[i] >= _budget.maxStepsPerTrial)) {
+				endOfEpisode(i, true);
+			} else {
+				_states[i] = _nextStates[i];
+				_actions[i] = _nextActions[i];
+			}
+		}
+		if(runLimitReached()) _budgetExhausted = true;
+	};
+
+	/*
+	 * Starts counting the run's budget
+	 */
+	void beginRun() {
+		_budgetExhausted = false;
+		_runStartSteps = _totalSteps;
+		_runStartTrials = _finishedTrials;
+		_runStart = std::chrono::steady_clock::now();
+	};
+
+	/*
+	 * Returns true if the run used all of its steps, episodes or time
+	 */
+	bool runLimitReached() const {
+		return ((_budget.maxSteps > 0) && (_totalSteps - _runStartSteps >= _budget.maxSteps)) ||
+				((_budget.maxTrials > 0) && (_finishedTrials - _runStartTrials >= _budget.maxTrials)) ||
+				((_budget.maxSeconds > 0.0) && (std::chrono::duration<double>(std::chrono::steady_clock::now() - _runStart).count() >= _budget.maxSeconds));
+	};
+
+	/*
+	 * Resets an agent whose episode ended and notifies the listeners
+	 * \param agent The index of the agent
+	 * \param truncated True if the episode was stopped by the step limit
+	 */
+	void endOfEpisode(int agent, bool truncated) {
+		_finishedTrials++;
+		QLLib::Utils::Stats stats;
+		stats.rewardsPerTrial = _rewardsPerEpisode[agent];
+		stats.stepsPerTrial = _stepsPerEpisode[agent];
+		stats.totalSteps = _totalSteps;
+		stats.trialsCompleted = _finishedTrials;
+		stats.truncated = truncated;
+		for(auto &listener : _listeners) listener(stats);
+		_stepsPerEpisode[agent] = 0;
+		_rewardsPerEpisode[agent] = 0.0;
+		_states[agent] = _problem->resetAgent(agent);
+		_algorithm->stepBatch(&_states[agent], &_actions[agent], 1);
+	};
+
+	QLLib::QLBatchProblem *_problem;
+	QLLib::QLAlgorithm *_algorithm;
+	bool _runTrial = true;
+	QLLib::Utils::Budget _budget;
+	bool _budgetExhausted = false;
+	int64_t _runStartSteps = 0;
+	int64_t _runStartTrials = 0;
+	std::chrono::steady_clock::time_point _runStart;
+	int64_t _totalSteps = 0;
+	int64_t _finishedTrials = 0;
+	std::vector<int> _states;
+	std::vector<int> _actions;
+	std::vector<int> _nextStates;
+	std::vector<int> _nextActions;
+	std::vector<double> _rewards;
+	std::unique_ptr<bool[]> _done;
+	std::vector<int> _stepsPerEpisode;
+	std::vector<double> _rewardsPerEpisode;
+	std::vector<std::function<void(const QLLib::Utils::Stats&)>> _listeners;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLBATCH_H_ */
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLCheckpoint.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLCHECKPOINT_H_
+#define QLCHECKPOINT_H_
+
+#include <cstdio>
+#include <fstream>
+#include "QLSnapshotTable.h"
+
+namespace QLLib {
+namespace Utils {
+
+/*
+ * DeltaHeader Struct
+ * The header of a record of an incremental checkpoint's log: it's followed by the ids of the changed states (uint32)
+ * and by their rows
+ */
+struct DeltaHeader {
+	char magic[8];
+	// The generation of the base the record applies to
+	uint64_t generation = 0;
+	// The number of states of the table when the record was written
+	uint64_t states = 0;
+	// The number of rows in the record
+	uint64_t rows = 0;
+
+	DeltaHeader() {
+		std::memcpy(magic, "QLDELTA", 8);
+	};
+
+	bool valid() const {
+		return std::memcmp(magic, "QLDELTA", 8) == 0;
+	};
+};
+
+} /* namespace Utils */
+
+/*
+ * QLCheckpoint Class
+ * The QLCheckpoint class writes incremental checkpoints of a BasicQLSnapshotTable: a base file with the whole table
+ * and a log ('path'.log) where each write() appends only the rows that changed since the previous write.
+ * Every 'compactEvery' writes the base is rewritten and the log is emptied, so restoring doesn't replay a long log.
+ * Checkpoint I/O is then proportional to the number of rows that change, not to the size of the table.
+ * The snapshots must be taken with their dirty rows, and each of them written, in order:
+ *
+ * 	QLLib::QLCheckpoint<double> checkpoint("table.ckpt");
+ * 	...
+ * 	checkpoint.write(algorithm->getTable().snapshot(true));
+ *
+ * write() only reads the snapshot, so it can run on another thread than training.
+ * The base is replaced atomically (written to a temporary file, then renamed), and every log record carries the
+ * generation of its base, so a crash during a write never restores rows on the wrong base.
+ */
+template<class T>
+class QLCheckpoint {
+public:
+	/*
+	 * QLCheckpoint Constructor
+	 * \param path The file name of the base (the log is 'path'.log)
+	 * \param compactEvery The number of writes between two compactions (1 writes the whole table every time)
+	 */
+	QLCheckpoint(const std::string &path, int compactEvery = 16) : _path(path), _compactEvery(compactEvery) {
+		// continue the generations of an existing checkpoint
+		std::ifstream in(path.c_str(), std::ios::binary);
+		QLLib::Utils::TableFileHeader h;
+		if(in.read(reinterpret_cast<char*>(&h), sizeof(h)) && h.valid()) _generation = h.generation;
+	};
+
+	virtual ~QLCheckpoint() {};
+
+	/*
+	 * Writes a snapshot: the changed rows are appended to the log, or the whole table is written if it's time to compact
+	 * Returns the number of bytes written
+	 * \param snapshot A snapshot taken with its dirty rows (see BasicQLSnapshotTable::snapshot())
+	 */
+	size_t write(const QLLib::QLTableSnapshot<T> &snapshot) {
+		if(!snapshot.hasDirtyRows()) {
+			throw std::logic_error("[ERROR] Checkpoints need snapshots taken with their dirty rows: call snapshot(true)");
+		}
+		if((_writes == 0) || (_sinceCompaction + 1 >= _compactEvery)) {
+			return compact(snapshot);
+		}
+		std::vector<int> dirty = snapshot.getDirtyRows();
+		std::ofstream out(logPath().c_str(), std::ios::binary | std::ios::app);
+		if(!out) throw std::runtime_error("[ERROR] Could not open \"" + logPath() + "\" for writing");
+		QLLib::Utils::DeltaHeader h;
+		h.generation = _generation;
+		h.states = snapshot.getStateCount();
+		h.rows = dirty.size();
+		out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+		std::vector<uint32_t> ids(dirty.begin(), dirty.end());
+		if(!ids.empty()) out.write(reinterpret_cast<const char*>(&ids[0]), ids.size() * sizeof(uint32_t));
+		size_t rowBytes = snapshot.getActionCount() * sizeof(T);
+		for(int s : dirty) out.write(reinterpret_cast<const char*>(snapshot.getRow(s)), rowBytes);
+		out.flush();
+		if(!out) throw std::runtime_error("[ERROR] Could not write \"" + logPath() + "\"");
+		_writes++;
+		_sinceCompaction++;
+		size_t bytes = sizeof(h) + ids.size() * sizeof(uint32_t) + dirty.size() * rowBytes;
+		_bytesWritten += bytes;
+		return bytes;
+	};
+
+	/*
+	 * Restores a checkpoint into a table: loads the base, then replays the log records of the same generation
+	 * (an incomplete record at the end of the log, i.e. after a crash, is ignored). Call it after the table is initialized
+	 * \param table The table
+	 * \param path The file name of the base
+	 */
+	static void restore(QLLib::BasicQLSnapshotTable<T> &table, const std::string &path) {
+		table.load(path);
+		QLLib::Utils::TableFileHeader base;
+		std::ifstream in(path.c_str(), std::ios::binary);
+		in.read(reinterpret_cast<char*>(&base), sizeof(base));
+		std::ifstream log((path + ".log").c_str(), std::ios::binary);
+		QLLib::Utils::DeltaHeader h;
+		std::vector<uint32_t> ids;
+		std::vector<T> rows;
+		size_t actions = table.getActionCount();
+		while(log.read(reinterpret_cast<char*>(&h), sizeof(h)) && h.valid()) {
+			ids.resize(h.rows);
+			rows.resize(h.rows * actions);
+			if(h.rows > 0) {
+				if(!log.read(reinterpret_cast<char*>(&ids[0]), h.rows * sizeof(uint32_t))) break;
+				if(!log.read(reinterpret_cast<char*>(&rows[0]), rows.size() * sizeof(T))) break;
+			}
+			if(h.generation != base.generation) continue;
+			for(size_t i = 0; i < h.rows; i++) {
+				for(size_t a = 0; a < actions; a++) table.set(ids[i], a, rows[i * actions + a]);
+			}
+		}
+	};
+
+	/*
+	 * Returns the number of bytes written by this writer
+	 */
+	size_t getBytesWritten() const {
+		return _bytesWritten;
+	};
+private:
+	/*
+	 * Writes the whole table as a new base and empties the log
+	 */
+	size_t compact(const QLLib::QLTableSnapshot<T> &snapshot) {
+		std::string tmp = _path + ".tmp";
+		snapshot.save(tmp, _generation + 1);
+		if(std::rename(tmp.c_str(), _path.c_str()) != 0) {
+			throw std::runtime_error("[ERROR] Could not replace \"" + _path + "\"");
+		}
+		_generation++;
+		std::ofstream log(logPath().c_str(), std::ios::binary | std::ios::trunc);
+		_writes++;
+		_sinceCompaction = 0;
+		size_t bytes = sizeof(QLLib::Utils::TableFileHeader) + snapshot.getStateCount() * snapshot.getActionCount() * sizeof(T);
+		_bytesWritten += bytes;
+		return bytes;
+	};
+
+	std::string logPath() const {
+		return _path + ".log";
+	};
+
+	std::string _path;
+	int _compactEvery;
+	uint64_t _generation = 0;
+	int _writes = 0;
+	int _sinceCompaction = 0;
+	size_t _bytesWritten = 0;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLCHECKPOINT_H_ */
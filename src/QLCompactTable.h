@@ -0,0 +1,467 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLCompactTable.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLCOMPACTTABLE_H_
+#define QLCOMPACTTABLE_H_
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "QLUtils.h"
+
+namespace QLLib {
+namespace Utils {
+
+/*
+ * Float32Codec Struct
+ * Stores Q-values as 32-bit floats
+ */
+struct Float32Codec {
+	typedef float Storage;
+
+	/*
+	 * Converts a value to its storage type
+	 * \param value The value
+	 * \param u A number in [0, 1): 0.5 rounds to nearest, a uniform random number rounds stochastically
+	 */
+	static float encode(double value, double u) {
+		float f = static_cast<float>(value);
+		if((static_cast<double>(f) == value) || !std::isfinite(f)) return f;
+		// f is the nearest float, g the float on the other side of value
+		float g = std::nextafter(f, (static_cast<double>(f) < value) ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity());
+		double p = (value - f) / (static_cast<double>(g) - f);
+		return (u < p) ? g : f;
+	};
+
+	static double decode(float s) {
+		return s;
+	};
+};
+
+/*
+ * Float16Codec Struct
+ * Stores Q-values as IEEE 754 half-precision floats (11 significant bits, largest value 65504)
+ */
+struct Float16Codec {
+	typedef uint16_t Storage;
+
+	/*
+	 * Converts a value to its storage type, clamping it to the largest half
+	 * \param value The value
+	 * \param u A number in [0, 1): 0.5 rounds to nearest, a uniform random number rounds stochastically
+	 */
+	static uint16_t encode(double value, double u) {
+		uint16_t lo = truncate(static_cast<float>(value));
+		if((lo & 0x7fff) == 0x7bff) return lo;
+		// halves of the same sign are ordered like their bit patterns, so lo + 1 is the next half away from zero
+		uint16_t hi = lo + 1;
+		double a = std::fabs(value);
+		double low = std::fabs(decode(lo));
+		double p = (a - low) / (std::fabs(decode(hi)) - low);
+		return (u < p) ? hi : lo;
+	};
+
+	static double decode(uint16_t h) {
+		uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+		uint32_t exponent = (h >> 10) & 0x1f;
+		uint32_t mantissa = h & 0x3ff;
+		if(exponent == 0) {
+			// subnormal: mantissa * 2^-24
+			float f = mantissa * (1.0f / 16777216.0f);
+			return sign ? -f : f;
+		}
+		uint32_t x;
+		if(exponent == 31) x = sign | 0x7f800000 | (mantissa << 13);
+		else x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		float f;
+		std::memcpy(&f, &x, sizeof(f));
+		return f;
+	};
+private:
+	/*
+	 * Converts a float to the nearest half towards zero
+	 */
+	static uint16_t truncate(float f) {
+		uint32_t x;
+		std::memcpy(&x, &f, sizeof(x));
+		uint16_t sign = (x >> 16) & 0x8000;
+		uint32_t a = x & 0x7fffffff;
+		// 65504 (the largest half) and above, infinities and NaNs
+		if(a >= 0x477fe000) return sign | 0x7bff;
+		// below 2^-14 halves are subnormal
+		if(a < 0x38800000) return sign | static_cast<uint16_t>(std::fabs(f) * 16777216.0f);
+		// rebias the exponent from 127 to 15 and keep the top 10 bits of the mantissa
+		return sign | static_cast<uint16_t>((a - 0x38000000) >> 13);
+	};
+};
+
+} /* namespace Utils */
+
+/*
+ * BasicQLCompactTable Class
+ * The BasicQLCompactTable class is a Q-table that stores Q-values in a smaller type than double
+ * (i.e. QLFloat16Table takes 2 bytes per Q-value instead of 8), with the same dense, row-per-state layout as QLLookupTable.
+ * Values are converted with Codec when they are read or written; the row max and argmax are computed on the decoded values.
+ * With stochastic rounding a value is rounded up or down with a probability proportional to its distance from each,
+ * so small updates aren't lost to rounding on average.
+ */
+template<class Codec>
+class BasicQLCompactTable {
+public:
+	typedef typename Codec::Storage Storage;
+
+	// row() decodes the values into the caller's scratch space, as doubles
+	typedef double Value;
+	static const bool copiesRows = true;
+	static const bool atomicAdd = false;
+
+	/*
+	 * BasicQLCompactTable Constructor
+	 * \param stochasticRounding True to round updates stochastically, false to round them to nearest
+	 */
+	BasicQLCompactTable(bool stochasticRounding = true) : _stochasticRounding(stochasticRounding) {};
+
+	virtual ~BasicQLCompactTable() {};
+
+	/*
+	 * Initializes the table, setting the default value for all state-action combinations
+	 * \param states The number of states known in advance
+	 * \param actions The number of actions
+	 * \param initialQ The default Q-value
+	 */
+	void init(size_t states, size_t actions, double initialQ) {
+		_actions = actions;
+		_states = states;
+		_initialQ = Codec::encode(initialQ, 0.5);
+		_values.assign(states * actions, _initialQ);
+	};
+
+	/*
+	 * Decodes the Q-values of all actions of a state
+	 * \param stateId The id of the state
+	 * \param scratch An array of getActionCount() doubles that receives the values
+	 */
+	double* row(int stateId, double *scratch) {
+		const Storage *q = getRow(stateId);
+		for(size_t i = 0; i < _actions; i++) scratch[i] = Codec::decode(q[i]);
+		return scratch;
+	};
+
+	/*
+	 * Copies the Q-values of a state without changing the table: states that don't have a row yet get the initial value.
+	 * Several threads can call it at the same time, as long as no thread changes the table
+	 * \param stateId The id of the state
+	 * \param Q Output: an array of getActionCount() doubles
+	 */
+	void copyRow(int stateId, double Q[]) const {
+		if(stateId < 0) {
+			throw std::out_of_range("[ERROR] The state isn't part of the problem");
+		}
+		bool known = static_cast<size_t>(stateId) < _states;
+		const Storage *q = known ? &_values[static_cast<size_t>(stateId) * _actions] : nullptr;
+		for(size_t i = 0; i < _actions; i++) Q[i] = Codec::decode(known ? q[i] : _initialQ);
+	};
+
+	/*
+	 * Returns the Q-value of a state-action combination
+	 */
+	double get(int stateId, int actionId) {
+		return Codec::decode(getRow(stateId)[actionId]);
+	};
+
+	/*
+	 * Sets the Q-value of a state-action combination
+	 */
+	void set(int stateId, int actionId, double value) {
+		getRow(stateId)[actionId] = Codec::encode(value, _stochasticRounding ? QLLib::Utils::uniformRand() : 0.5);
+	};
+
+	/*
+	 * Returns the largest Q-value of a state
+	 */
+	double max(int stateId) {
+		return get(stateId, argmax(stateId));
+	};
+
+	/*
+	 * Returns the index of the action with the largest Q-value of a state (the first one, if there are several)
+	 */
+	int argmax(int stateId) {
+		const Storage *q = getRow(stateId);
+		int best = 0;
+		double bestQ = Codec::decode(q[0]);
+		for(size_t i = 1; i < _actions; i++) {
+			double v = Codec::decode(q[i]);
+			if(bestQ < v) {
+				bestQ = v;
+				best = i;
+			}
+		}
+		return best;
+	};
+
+	/*
+	 * Returns the number of states that have a row in the table
+	 */
+	size_t getStateCount() const {
+		return _states;
+	};
+
+	/*
+	 * Returns the number of actions (the length of each row)
+	 */
+	size_t getActionCount() const {
+		return _actions;
+	};
+
+	/*
+	 * Allocates the storage for the rows of 'states' states (see BasicQLLookupTable::reserve())
+	 */
+	void reserve(size_t states) {
+		_values.reserve(states * _actions);
+	};
+
+	/*
+	 * Returns the number of bytes allocated for the Q-values
+	 */
+	size_t getMemoryUsage() const {
+		return _values.capacity() * sizeof(Storage);
+	};
+
+	/*
+	 * Returns the number of bytes the Q-values of a table of this type would take, without allocating it
+	 */
+	static size_t estimateMemory(size_t states, size_t actions) {
+		return states * actions * sizeof(Storage);
+	};
+private:
+	Storage* getRow(int stateId) {
+		if(static_cast<size_t>(stateId) >= _states) grow(stateId);
+		return &_values[static_cast<size_t>(stateId) * _actions];
+	};
+
+	void grow(int stateId) {
+		if(stateId < 0) {
+			throw std::out_of_range("[ERROR] The state isn't part of the problem");
+		}
+		_states = static_cast<size_t>(stateId) + 1;
+		_values.resize(_states * _actions, _initialQ);
+	};
+
+	std::vector<Storage> _values;
+	size_t _states = 0;
+	size_t _actions = 0;
+	Storage _initialQ = Storage();
+	bool _stochasticRounding;
+};
+
+/*
+ * QLFloat32Table
+ * Q-values stored as 32-bit floats (half the size of QLLookupTable)
+ */
+typedef BasicQLCompactTable<QLLib::Utils::Float32Codec> QLFloat32Table;
+
+/*
+ * QLFloat16Table
+ * Q-values stored as 16-bit floats (a quarter of the size of QLLookupTable)
+ */
+typedef BasicQLCompactTable<QLLib::Utils::Float16Codec> QLFloat16Table;
+
+/*
+ * QLInt8Table Class
+ * The QLInt8Table class stores each Q-value as an 8-bit integer, plus one scale per row:
+ * Q(s,a) = value(s,a) * scale(s). That's about an eighth of the size of QLLookupTable.
+ * A row's scale grows when a value doesn't fit in it (the other values of the row are requantized), and never shrinks.
+ * Since the scale is positive, the row max and argmax are found on the integers and only the result is decoded.
+ */
+class QLInt8Table {
+public:
+	// row() decodes the values into the caller's scratch space, as doubles
+	typedef double Value;
+	static const bool copiesRows = true;
+	static const bool atomicAdd = false;
+
+	/*
+	 * QLInt8Table Constructor
+	 * \param stochasticRounding True to round updates stochastically, false to round them to nearest
+	 */
+	QLInt8Table(bool stochasticRounding = true) : _stochasticRounding(stochasticRounding) {};
+
+	virtual ~QLInt8Table() {};
+
+	/*
+	 * Initializes the table, setting the default value for all state-action combinations
+	 * \param states The number of states known in advance
+	 * \param actions The number of actions
+	 * \param initialQ The default Q-value
+	 */
+	void init(size_t states, size_t actions, double initialQ) {
+		_actions = actions;
+		_states = states;
+		// the initial value is represented exactly: +/-127 times a scale of |initialQ|/127
+		_initialScale = static_cast<float>(std::fabs(initialQ) / 127.0);
+		_initialValue = (initialQ > 0) ? 127 : ((initialQ < 0) ? -127 : 0);
+		_values.assign(states * actions, _initialValue);
+		_scales.assign(states, _initialScale);
+	};
+
+	/*
+	 * Decodes the Q-values of all actions of a state
+	 * \param stateId The id of the state
+	 * \param scratch An array of getActionCount() doubles that receives the values
+	 */
+	double* row(int stateId, double *scratch) {
+		const int8_t *q = getRow(stateId);
+		double scale = _scales[stateId];
+		for(size_t i = 0; i < _actions; i++) scratch[i] = q[i] * scale;
+		return scratch;
+	};
+
+	/*
+	 * Copies the Q-values of a state without changing the table: states that don't have a row yet get the initial value.
+	 * Several threads can call it at the same time, as long as no thread changes the table
+	 * \param stateId The id of the state
+	 * \param Q Output: an array of getActionCount() doubles
+	 */
+	void copyRow(int stateId, double Q[]) const {
+		if(stateId < 0) {
+			throw std::out_of_range("[ERROR] The state isn't part of the problem");
+		}
+		bool known = static_cast<size_t>(stateId) < _states;
+		const int8_t *q = known ? &_values[static_cast<size_t>(stateId) * _actions] : nullptr;
+		double scale = known ? _scales[stateId] : _initialScale;
+		for(size_t i = 0; i < _actions; i++) Q[i] = (known ? q[i] : _initialValue) * scale;
+	};
+
+	/*
+	 * Returns the Q-value of a state-action combination
+	 */
+	double get(int stateId, int actionId) {
+		return getRow(stateId)[actionId] * static_cast<double>(_scales[stateId]);
+	};
+
+	/*
+	 * Sets the Q-value of a state-action combination
+	 */
+	void set(int stateId, int actionId, double value) {
+		int8_t *q = getRow(stateId);
+		double scale = _scales[stateId];
+		if(std::fabs(value) > 127.0 * scale) {
+			// the value doesn't fit: grow the row's scale and requantize the other values
+			double newScale = std::fabs(value) / 127.0;
+			for(size_t i = 0; i < _actions; i++) {
+				q[i] = static_cast<int8_t>(std::lround(q[i] * scale / newScale));
+			}
+			_scales[stateId] = static_cast<float>(newScale);
+			scale = _scales[stateId];
+		}
+		if(scale == 0.0) return;
+		double u = _stochasticRounding ? QLLib::Utils::uniformRand() : 0.5;
+		double v = std::floor(value / scale + u);
+		if(v > 127.0) v = 127.0;
+		if(v < -127.0) v = -127.0;
+		q[actionId] = static_cast<int8_t>(v);
+	};
+
+	/*
+	 * Returns the largest Q-value of a state
+	 */
+	double max(int stateId) {
+		return get(stateId, argmax(stateId));
+	};
+
+	/*
+	 * Returns the index of the action with the largest Q-value of a state (the first one, if there are several)
+	 */
+	int argmax(int stateId) {
+		const int8_t *q = getRow(stateId);
+		int best = 0;
+		for(size_t i = 1; i < _actions; i++) {
+			if(q[best] < q[i]) best = i;
+		}
+		return best;
+	};
+
+	/*
+	 * Returns the number of states that have a row in the table
+	 */
+	size_t getStateCount() const {
+		return _states;
+	};
+
+	/*
+	 * Returns the number of actions (the length of each row)
+	 */
+	size_t getActionCount() const {
+		return _actions;
+	};
+
+	/*
+	 * Allocates the storage for the rows of 'states' states (see BasicQLLookupTable::reserve())
+	 */
+	void reserve(size_t states) {
+		_values.reserve(states * _actions);
+		_scales.reserve(states);
+	};
+
+	/*
+	 * Returns the number of bytes allocated for the Q-values and the rows' scales
+	 */
+	size_t getMemoryUsage() const {
+		return _values.capacity() * sizeof(int8_t) + _scales.capacity() * sizeof(float);
+	};
+
+	/*
+	 * Returns the number of bytes the Q-values and scales of a table of this type would take, without allocating it
+	 */
+	static size_t estimateMemory(size_t states, size_t actions) {
+		return states * actions * sizeof(int8_t) + states * sizeof(float);
+	};
+private:
+	int8_t* getRow(int stateId) {
+		if(static_cast<size_t>(stateId) >= _states) grow(stateId);
+		return &_values[static_cast<size_t>(stateId) * _actions];
+	};
+
+	void grow(int stateId) {
+		if(stateId < 0) {
+			throw std::out_of_range("[ERROR] The state isn't part of the problem");
+		}
+		_states = static_cast<size_t>(stateId) + 1;
+		_values.resize(_states * _actions, _initialValue);
+		_scales.resize(_states, _initialScale);
+	};
+
+	std::vector<int8_t> _values;
+	std::vector<float> _scales;
+	size_t _states = 0;
+	size_t _actions = 0;
+	int8_t _initialValue = 0;
+	float _initialScale = 0.0f;
+	bool _stochasticRounding;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLCOMPACTTABLE_H_ */
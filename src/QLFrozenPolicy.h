@@ -0,0 +1,288 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLFrozenPolicy.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLFROZENPOLICY_H_
+#define QLFROZENPOLICY_H_
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "QL.h"
+
+namespace QLLib {
+
+/*
+ * QLFrozenPolicy Class
+ * The QLFrozenPolicy class is the greedy policy of a trained algorithm, compiled for inference:
+ * for each state it stores the ids of the k actions with the largest Q-values (best first, ties go to the lower id),
+ * so choosing an action is a single array read, without Q-values or virtual calls.
+ * A frozen policy can be saved to a binary file that is memory-mapped when it's loaded,
+ * or exported as a C++ header with the policy in a constexpr array.
+ */
+class QLFrozenPolicy {
+public:
+	/*
+	 * QLFrozenPolicy Constructor
+	 * Creates an empty policy, use load() to read a saved one
+	 */
+	QLFrozenPolicy() {};
+
+	/*
+	 * QLFrozenPolicy Constructor
+	 * Freezes the greedy policy of an algorithm
+	 * \param algorithm A trained algorithm
+	 * \param k The number of actions kept for each state (1 keeps only the best one)
+	 */
+	QLFrozenPolicy(QLLib::QLAlgorithm *algorithm, int k = 1) {
+		_states = algorithm->getStateCount();
+		_actionCount = algorithm->getActionCount();
+		if((_actionCount == 0) || (_actionCount > 65536)) {
+			throw std::out_of_range("[ERROR] A frozen policy needs between 1 and 65536 actions");
+		}
+		_k = std::max(1, std::min(k, static_cast<int>(_actionCount)));
+		_values.resize(_states * _k);
+		std::vector<double> q(_actionCount);
+		std::vector<int> order(_actionCount);
+		const QLLib::QLActionMask *mask = algorithm->getActionMask();
+		std::vector<double> validQ;
+		for(size_t s = 0; s < _states; s++) {
+			algorithm->getQValues(s, &q[0]);
+			if((mask != nullptr) && (s < mask->getStateCount())) {
+				// invalid actions are ranked after all valid ones
+				const uint16_t *valid;
+				int count = mask->getActions(s, valid);
+				validQ = q;
+				std::fill(q.begin(), q.end(), -std::numeric_limits<double>::infinity());
+				for(int i = 0; i < count; i++) q[valid[i]] = validQ[valid[i]];
+			}
+			for(size_t a = 0; a < _actionCount; a++) order[a] = a;
+			std::partial_sort(order.begin(), order.begin() + _k, order.end(), [&q](int a, int b) {
+				return (q[a] > q[b]) || ((q[a] == q[b]) && (a < b));
+			});
+			for(int i = 0; i < _k; i++) _values[s * _k + i] = order[i];
+		}
+		_data = _values.empty() ? nullptr : &_values[0];
+	};
+
+	virtual ~QLFrozenPolicy() {
+		unmap();
+	};
+
+	QLFrozenPolicy(const QLFrozenPolicy&) = delete;
+	QLFrozenPolicy& operator=(const QLFrozenPolicy&) = delete;
+
+	/*
+	 * Returns the id of the best action of a state
+	 * There's no bounds check: the id must be smaller than getStateCount()
+	 * \param stateId The id of the state
+	 */
+	int getAction(int stateId) const {
+		return _data[static_cast<size_t>(stateId) * _k];
+	};
+
+	/*
+	 * Returns the best action of a state
+	 * \param state An instance of QLState
+	 */
+	int getAction(const QLLib::QLState &state) const {
+		return getAction(state.getId());
+	};
+
+	/*
+	 * Returns the ids of the k best actions of a state, best first
+	 * \param stateId The id of the state
+	 */
+	const uint16_t* getTopActions(int stateId) const {
+		return _data + static_cast<size_t>(stateId) * _k;
+	};
+
+	/*
+	 * Returns the number of states
+	 */
+	size_t getStateCount() const {
+		return _states;
+	};
+
+	/*
+	 * Returns the number of actions of the problem
+	 */
+	size_t getActionCount() const {
+		return _actionCount;
+	};
+
+	/*
+	 * Returns the number of actions kept for each state
+	 */
+	int getK() const {
+		return _k;
+	};
+
+	/*
+	 * Saves the policy to a binary file: a Header followed by the action ids (getStateCount() * getK() uint16)
+	 * \param path The file name
+	 */
+	void save(const std::string &path) const {
+		std::ofstream out(path.c_str(), std::ios::binary);
+		if(!out) throw std::runtime_error("[ERROR] Could not open \"" + path + "\" for writing");
+		Header h;
+		std::memcpy(h.magic, "QLFP", 4);
+		h.version = 1;
+		h.states = _states;
+		h.actions = _actionCount;
+		h.k = _k;
+		out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+		out.write(reinterpret_cast<const char*>(_data), _states * _k * sizeof(uint16_t));
+		if(!out) throw std::runtime_error("[ERROR] Could not write \"" + path + "\"");
+	};
+
+	/*
+	 * Loads a policy saved with save(). The file is memory-mapped (read into memory on Windows),
+	 * so loading is immediate and processes that load the same file share its pages
+	 * \param path The file name
+	 */
+	void load(const std::string &path) {
+		unmap();
+		_values.clear();
+#ifndef _WIN32
+		int fd = open(path.c_str(), O_RDONLY);
+		if(fd < 0) throw std::runtime_error("[ERROR] Could not open \"" + path + "\"");
+		struct stat st;
+		if(fstat(fd, &st) != 0) {
+			close(fd);
+			throw std::runtime_error("[ERROR] Could not read \"" + path + "\"");
+		}
+		_mapSize = st.st_size;
+		void *map = (_mapSize > 0) ? mmap(nullptr, _mapSize, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+		close(fd);
+		if(map == MAP_FAILED) {
+			_mapSize = 0;
+			throw std::runtime_error("[ERROR] Could not map \"" + path + "\"");
+		}
+		_map = map;
+		const char *bytes = static_cast<const char*>(_map);
+		size_t size = _mapSize;
+#else
+		std::ifstream in(path.c_str(), std::ios::binary);
+		if(!in) throw std::runtime_error("[ERROR] Could not open \"" + path + "\"");
+		std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		const char *bytes = file.empty() ? nullptr : &file[0];
+		size_t size = file.size();
+#endif
+		Header h;
+		if(size >= sizeof(h)) std::memcpy(&h, bytes, sizeof(h));
+		if((size < sizeof(h)) || (std::memcmp(h.magic, "QLFP", 4) != 0) || (h.version != 1) || (h.k == 0) ||
+				(size != sizeof(h) + static_cast<size_t>(h.states) * h.k * sizeof(uint16_t))) {
+			unmap();
+			throw std::runtime_error("[ERROR] \"" + path + "\" isn't a frozen policy");
+		}
+		_states = h.states;
+		_actionCount = h.actions;
+		_k = h.k;
+#ifndef _WIN32
+		_data = reinterpret_cast<const uint16_t*>(bytes + sizeof(h));
+#else
+		_values.resize(_states * _k);
+		if(!_values.empty()) std::memcpy(&_values[0], bytes + sizeof(h), _values.size() * sizeof(uint16_t));
+		_data = _values.empty() ? nullptr : &_values[0];
+#endif
+	};
+
+	/*
+	 * Writes a C++ header with the policy, for deployments that compile it in:
+	 * the header declares the namespace 'name', with constexpr kStates, kActions, kTopK, the kPolicy array
+	 * (uint8_t ids when there are at most 256 actions) and a constexpr action(stateId) function
+	 * \param path The file name
+	 * \param name The namespace of the generated code
+	 */
+	void exportHeader(const std::string &path, const std::string &name) const {
+		std::ofstream out(path.c_str());
+		if(!out) throw std::runtime_error("[ERROR] Could not open \"" + path + "\" for writing");
+		std::string guard = name;
+		for(auto &c : guard) c = std::isalnum(static_cast<unsigned char>(c)) ? std::toupper(static_cast<unsigned char>(c)) : '_';
+		out << "// Frozen Q-learning policy generated by QLLib, do not edit" << std::endl;
+		out << "#ifndef " << guard << "_POLICY_H_" << std::endl;
+		out << "#define " << guard << "_POLICY_H_" << std::endl << std::endl;
+		out << "#include <cstdint>" << std::endl << std::endl;
+		out << "namespace " << name << " {" << std::endl << std::endl;
+		out << "constexpr int kStates = " << _states << ";" << std::endl;
+		out << "constexpr int kActions = " << _actionCount << ";" << std::endl;
+		out << "constexpr int kTopK = " << _k << ";" << std::endl << std::endl;
+		out << "// the ids of the best kTopK actions of each state, best first" << std::endl;
+		out << "constexpr " << ((_actionCount <= 256) ? "uint8_t" : "uint16_t") << " kPolicy[] = {";
+		size_t n = _states * _k;
+		for(size_t i = 0; i < n; i++) {
+			if((i % 32) == 0) out << std::endl << "\t";
+			out << _data[i] << ((i + 1 < n) ? "," : "");
+		}
+		if(n == 0) out << std::endl << "\t0";
+		out << std::endl << "};" << std::endl << std::endl;
+		out << "constexpr int action(int stateId) {" << std::endl;
+		out << "\treturn kPolicy[stateId * kTopK];" << std::endl;
+		out << "}" << std::endl << std::endl;
+		out << "} /* namespace " << name << " */" << std::endl << std::endl;
+		out << "#endif" << std::endl;
+		if(!out) throw std::runtime_error("[ERROR] Could not write \"" + path + "\"");
+	};
+private:
+	// The header of the binary files
+	struct Header {
+		char magic[4];
+		uint32_t version;
+		uint32_t states;
+		uint32_t actions;
+		uint32_t k;
+		uint32_t reserved = 0;
+	};
+
+	void unmap() {
+#ifndef _WIN32
+		if(_map != nullptr) munmap(_map, _mapSize);
+#endif
+		_map = nullptr;
+		_mapSize = 0;
+		_data = nullptr;
+		_states = 0;
+	};
+
+	std::vector<uint16_t> _values;
+	const uint16_t *_data = nullptr;
+	size_t _states = 0;
+	size_t _actionCount = 0;
+	int _k = 1;
+	void *_map = nullptr;
+	size_t _mapSize = 0;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLFROZENPOLICY_H_ */
@@ -1,69 +1,319 @@
-/*
- * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *     http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- *
- * QLLookupTable.h
- *
- *  Created on: Dec 15, 2015
- *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
- */
-
-#ifndef QLLOOKUPTABLE_H_
-#define QLLOOKUPTABLE_H_
-
-#include <unordered_map>
-#include "QLStateAction.h"
-
-namespace QLLib {
-
-/*
- * QLLookupTable Class
- * The QLLookupTable class is an in-memory hash table that contains Q-values for all mapped state-action combinations
- */
-class QLLookupTable {
-public:
-	typedef std::unordered_map<QLStateAction, double, QLStateActionHash> DataMap;
-
-	/*
-	 * QLLookupTable Constructor
-	 */
-	QLLookupTable() {};
-
-	virtual ~QLLookupTable() {};
-
-	/*
-	 * Save Q-value for the specified state-action combination
-	 * \param state An instance of QLState
-	 * \param action An instance of QLAction
-	 * \param value The Q-value to save
-	 */
-	void setStateAndAction(QLLib::QLState state, QLLib::QLAction action, double value) {
-		_lookupTable[QLStateAction(state, action)] = value;
-	};
-
-	/*
-	 * Lookup Q-value for the specified state-action combination
-	 * \param state An instance of QLState
-	 * \param action An instance of QLAction
-	 */
-	double lookupStateAndAction(QLLib::QLState state, QLLib::QLAction action) {
-		return _lookupTable.at(QLStateAction(state, action));
-	};
-private:
-	DataMap _lookupTable;
-};
-
-} /* namespace QLLib */
-
-#endif /* QLLOOKUPTABLE_H_ */
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLLookupTable.h
+ *
+ *  Created on: Dec 15, 2015
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLLOOKUPTABLE_H_
+#define QLLOOKUPTABLE_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "QLState.h"
+#include "QLAction.h"
+#include "QLUtils.h"
+
+namespace QLLib {
+
+/*
+ * BasicQLLookupTable Class
+ * The BasicQLLookupTable class is an in-memory table that contains Q-values for all mapped state-action combinations.
+ * Q-values are stored densely, one row of actions per state, indexed by the states' and actions' ids.
+ * Rows are created when a state is first looked up, so states created on demand get a row when they are visited
+ * T is the type of the Q-values: float halves the memory and doubles the number of values per cache line,
+ * which makes a difference on large state spaces. The algorithms and policies work directly on rows of either type
+ */
+template<class T>
+class BasicQLLookupTable {
+public:
+	// the type of the Q-values in the rows returned by row()
+	typedef T Value;
+
+	// row() returns the table's own storage, so the algorithms don't need scratch space for rows
+	static const bool copiesRows = false;
+	// set() overwrites the value, updates aren't atomic (see QLSharedTable.h)
+	static const bool atomicAdd = false;
+
+	/*
+	 * BasicQLLookupTable Constructor
+	 */
+	BasicQLLookupTable() {};
+
+	virtual ~BasicQLLookupTable() {};
+
+	/*
+	 * Initializes the table, setting the default value for all state-action combinations
+	 * \param states The number of states known in advance
+	 * \param actions The number of actions
+	 * \param initialQ The default Q-value
+	 */
+	void init(size_t states, size_t actions, double initialQ) {
+		_actions = actions;
+		_initialQ = initialQ;
+		_states = states;
+		_values.assign(states * actions, static_cast<T>(initialQ));
+	};
+
+	/*
+	 * Returns the Q-values of all actions of a state, in the order the actions were added to the problem
+	 * The pointer is valid until a row for a new state is created
+	 * \param stateId The id of the state
+	 */
+	T* getRow(int stateId) {
+		if(static_cast<size_t>(stateId) >= _states) grow(stateId);
+		return &_values[static_cast<size_t>(stateId) * _actions];
+	};
+
+	/*
+	 * Returns the Q-values of all actions of a state (the interface shared by all Q-tables, see QLCompactTable.h)
+	 * \param stateId The id of the state
+	 * \param scratch Unused: the row is returned in place
+	 */
+	T* row(int stateId, double *scratch) {
+		return getRow(stateId);
+	};
+
+	/*
+	 * Copies the Q-values of a state without changing the table: states that don't have a row yet get the initial value.
+	 * Several threads can call it at the same time, as long as no thread changes the table
+	 * \param stateId The id of the state
+	 * \param Q Output: an array of getActionCount() doubles
+	 */
+	void copyRow(int stateId, double Q[]) const {
+		if(stateId < 0) {
+			throw std::out_of_range("[ERROR] The state isn't part of the problem");
+		}
+		if(static_cast<size_t>(stateId) >= _states) {
+			for(size_t i = 0; i < _actions; i++) Q[i] = _initialQ;
+			return;
+		}
+		const T *q = &_values[static_cast<size_t>(stateId) * _actions];
+		for(size_t i = 0; i < _actions; i++) Q[i] = q[i];
+	};
+
+	/*
+	 * Returns the Q-value of a state-action combination
+	 * \param stateId The id of the state
+	 * \param actionId The id of the action
+	 */
+	double get(int stateId, int actionId) {
+		return getRow(stateId)[actionId];
+	};
+
+	/*
+	 * Sets the Q-value of a state-action combination
+	 * \param stateId The id of the state
+	 * \param actionId The id of the action
+	 * \param value The Q-value
+	 */
+	void set(int stateId, int actionId, double value) {
+		getRow(stateId)[actionId] = static_cast<T>(value);
+	};
+
+	/*
+	 * Returns the largest Q-value of a state
+	 * \param stateId The id of the state
+	 */
+	double max(int stateId) {
+		const T *q = getRow(stateId);
+		T maxQ = q[0];
+		for(size_t i = 1; i < _actions; i++) {
+			if(maxQ < q[i]) maxQ = q[i];
+		}
+		return maxQ;
+	};
+
+	/*
+	 * Returns the index of the action with the largest Q-value of a state (the first one, if there are several)
+	 * \param stateId The id of the state
+	 */
+	int argmax(int stateId) {
+		return QLLib::Utils::indexOfLargest(getRow(stateId), _actions);
+	};
+
+	/*
+	 * Save Q-value for the specified state-action combination
+	 * \param state An instance of QLState
+	 * \param action An instance of QLAction
+	 * \param value The Q-value to save
+	 */
+	void setStateAndAction(const QLLib::QLState &state, const QLLib::QLAction &action, double value) {
+		getRow(state.getId())[action.getId()] = static_cast<T>(value);
+	};
+
+	/*
+	 * Lookup Q-value for the specified state-action combination
+	 * \param state An instance of QLState
+	 * \param action An instance of QLAction
+	 */
+	double lookupStateAndAction(const QLLib::QLState &state, const QLLib::QLAction &action) {
+		return getRow(state.getId())[action.getId()];
+	};
+
+	/*
+	 * Returns the number of states that have a row in the table
+	 */
+	size_t getStateCount() const {
+		return _states;
+	};
+
+	/*
+	 * Returns the number of actions (the length of each row)
+	 */
+	size_t getActionCount() const {
+		return _actions;
+	};
+
+	/*
+	 * Allocates the storage for the rows of 'states' states, so rows created on demand don't reallocate the table.
+	 * Call it after the table is initialized (see QLProblem::setExpectedCounts())
+	 * \param states The number of states expected
+	 */
+	void reserve(size_t states) {
+		_values.reserve(states * _actions);
+	};
+
+	/*
+	 * Returns the number of bytes allocated for the Q-values
+	 */
+	size_t getMemoryUsage() const {
+		return _values.capacity() * sizeof(T);
+	};
+
+	/*
+	 * Returns the number of bytes the Q-values of a table of this type would take, without allocating it
+	 * \param states The number of states
+	 * \param actions The number of actions
+	 */
+	static size_t estimateMemory(size_t states, size_t actions) {
+		return states * actions * sizeof(T);
+	};
+private:
+	void grow(int stateId) {
+		if(stateId < 0) {
+			throw std::out_of_range("[ERROR] The state isn't part of the problem");
+		}
+		_states = static_cast<size_t>(stateId) + 1;
+		_values.resize(_states * _actions, static_cast<T>(_initialQ));
+	};
+
+	std::vector<T> _values;
+	size_t _states = 0;
+	size_t _actions = 0;
+	double _initialQ = 0.0;
+};
+
+// Q-table of doubles, the default of the algorithms
+typedef BasicQLLookupTable<double> QLLookupTable;
+
+// Q-table of floats
+typedef BasicQLLookupTable<float> QLFloatLookupTable;
+
+/*
+ * QLVisitTable Class
+ * The QLVisitTable class counts how many times each state-action combination was updated.
+ * It has the same layout as QLLookupTable (one row of actions per state, created on demand),
+ * with 32-bit counters so it takes half the memory of the Q-values.
+ */
+class QLVisitTable {
+public:
+	/*
+	 * QLVisitTable Constructor
+	 */
+	QLVisitTable() {};
+
+	virtual ~QLVisitTable() {};
+
+	/*
+	 * Initializes the table, setting all counters to 0
+	 * \param states The number of states known in advance
+	 * \param actions The number of actions
+	 */
+	void init(size_t states, size_t actions) {
+		_actions = actions;
+		_states = states;
+		_counts.assign(states * actions, 0);
+	};
+
+	/*
+	 * Returns the counters of all actions of a state
+	 * The pointer is valid until a row for a new state is created
+	 * \param stateId The id of the state
+	 */
+	uint32_t* getRow(int stateId) {
+		if(static_cast<size_t>(stateId) >= _states) grow(stateId);
+		return &_counts[static_cast<size_t>(stateId) * _actions];
+	};
+
+	/*
+	 * Increments the counter of a state-action combination and returns its new value
+	 * \param stateId The id of the state
+	 * \param actionId The id of the action
+	 */
+	uint32_t visit(int stateId, int actionId) {
+		uint32_t &n = getRow(stateId)[actionId];
+		if(n < UINT32_MAX) n++;
+		return n;
+	};
+
+	/*
+	 * Returns true if the table was initialized
+	 */
+	bool enabled() const {
+		return _actions > 0;
+	};
+
+	/*
+	 * Allocates the storage for the counters of 'states' states
+	 * \param states The number of states expected
+	 */
+	void reserve(size_t states) {
+		_counts.reserve(states * _actions);
+	};
+
+	/*
+	 * Returns the number of bytes allocated for the counters
+	 */
+	size_t getMemoryUsage() const {
+		return _counts.capacity() * sizeof(uint32_t);
+	};
+
+	/*
+	 * Returns the number of bytes the counters of 'states' states would take, without allocating them
+	 */
+	static size_t estimateMemory(size_t states, size_t actions) {
+		return states * actions * sizeof(uint32_t);
+	};
+private:
+	void grow(int stateId) {
+		if(stateId < 0) {
+			throw std::out_of_range("[ERROR] The state isn't part of the problem");
+		}
+		_states = static_cast<size_t>(stateId) + 1;
+		_counts.resize(_states * _actions, 0);
+	};
+
+	std::vector<uint32_t> _counts;
+	size_t _states = 0;
+	size_t _actions = 0;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLLOOKUPTABLE_H_ */
@@ -0,0 +1,276 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLMetricsSink.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLMETRICSSINK_H_
+#define QLMETRICSSINK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "QLUtils.h"
+
+namespace QLLib {
+namespace Utils {
+
+/*
+ * The file format of a metrics sink
+ */
+enum class MetricsFormat {
+	CSV,	// one line per trial, with a header line
+	Binary	// a header followed by fixed-size MetricsRecords
+};
+
+/*
+ * MetricsOptions Struct
+ * A utility struct to configure a metrics sink
+ */
+struct MetricsOptions {
+	MetricsFormat format = MetricsFormat::CSV;
+	// Start a new file when the current one reaches this size (0 never rotates)
+	size_t rotateBytes = 0;
+	// The size of the write buffer: the file is only written when the buffer is full
+	size_t bufferBytes = 1 << 20;
+	// Only write the stats of one trial every 'sampleEvery' (1 writes all of them)
+	int sampleEvery = 1;
+};
+
+/*
+ * MetricsRecord Struct
+ * A trial's stats in a binary metrics file
+ */
+struct MetricsRecord {
+	int64_t trialsCompleted;
+	int64_t totalSteps;
+	int32_t stepsPerTrial;
+	int32_t policyChanges;
+	// 1 if the trial was truncated
+	int32_t truncated;
+	int32_t reserved;
+	double rewardsPerTrial;
+	double maxDeltaQ;
+	double meanDeltaQ;
+};
+
+} /* namespace Utils */
+
+/*
+ * QLMetricsSink Class
+ * The QLMetricsSink class writes the stats of finished trials to CSV or binary files.
+ * Stats are formatted into a fixed-size buffer that is written to the file when it's full, so memory use is constant
+ * and trials don't pay for a flush. Files can be rotated by size: with rotation the files are named
+ * 'path'.0000.csv, 'path'.0001.csv, ... ('.bin' for binary files), otherwise 'path'.csv.
+ * Use it through QL::addMetricsSink(), which writes on the notifier thread so the simulation never waits for the disk.
+ * Only the constructor throws: if a file can't be written later, the error is recorded (see getError())
+ * and the sink stops writing, so a full disk doesn't end the simulation.
+ */
+class QLMetricsSink {
+public:
+	/*
+	 * QLMetricsSink Constructor - opens the first file, throws std::runtime_error if it can't
+	 * \param path The name of the files, without extension
+	 * \param options The format, rotation, buffer size and downsampling
+	 */
+	QLMetricsSink(const std::string &path, QLLib::Utils::MetricsOptions options = QLLib::Utils::MetricsOptions()) : _path(path), _options(options) {
+		_buffer.reserve(_options.bufferBytes + kMaxRecordBytes);
+		open();
+		if(_failed.load()) throw std::runtime_error(_error);
+	};
+
+	/*
+	 * QLMetricsSink Destructor - writes the buffered stats and closes the file
+	 */
+	virtual ~QLMetricsSink() {
+		close();
+	};
+
+	QLMetricsSink(const QLMetricsSink&) = delete;
+	QLMetricsSink& operator=(const QLMetricsSink&) = delete;
+
+	/*
+	 * Writes the stats of a batch of trials (downsampling is applied by the notifier, see QL::addMetricsSink())
+	 * \param batch The stats
+	 */
+	void write(const std::vector<QLLib::Utils::Stats> &batch) {
+		for(auto &stats : batch) write(stats);
+	};
+
+	/*
+	 * Writes the stats of a trial
+	 * \param stats The stats
+	 */
+	void write(const QLLib::Utils::Stats &stats) {
+		if(_file == nullptr) return;
+		if(_options.format == QLLib::Utils::MetricsFormat::CSV) {
+			char line[kMaxRecordBytes];
+			int n = std::snprintf(line, sizeof(line), "%lld,%lld,%d,%.17g,%.17g,%.17g,%d,%d\n", static_cast<long long>(stats.trialsCompleted), static_cast<long long>(stats.totalSteps),
+					stats.stepsPerTrial, stats.rewardsPerTrial, stats.maxDeltaQ, stats.meanDeltaQ, stats.policyChanges, stats.truncated ? 1 : 0);
+			append(line, std::min<size_t>(n, sizeof(line) - 1));
+		} else {
+			QLLib::Utils::MetricsRecord r;
+			r.trialsCompleted = stats.trialsCompleted;
+			r.totalSteps = stats.totalSteps;
+			r.stepsPerTrial = stats.stepsPerTrial;
+			r.policyChanges = stats.policyChanges;
+			r.truncated = stats.truncated ? 1 : 0;
+			r.reserved = 0;
+			r.rewardsPerTrial = stats.rewardsPerTrial;
+			r.maxDeltaQ = stats.maxDeltaQ;
+			r.meanDeltaQ = stats.meanDeltaQ;
+			append(reinterpret_cast<const char*>(&r), sizeof(r));
+		}
+		if(_file != nullptr) _records++;
+	};
+
+	/*
+	 * Writes the buffered stats to the file
+	 */
+	void flush() {
+		if((_file == nullptr) || _buffer.empty()) return;
+		if((std::fwrite(&_buffer[0], 1, _buffer.size(), _file) != _buffer.size()) || (std::fflush(_file) != 0)) {
+			fail("[ERROR] Could not write \"" + _fileName + "\"");
+			return;
+		}
+		_fileBytes += _buffer.size();
+		_buffer.clear();
+	};
+
+	/*
+	 * Writes the buffered stats and closes the file
+	 */
+	void close() {
+		if(_file == nullptr) return;
+		flush();
+		if(_file == nullptr) return;
+		std::FILE *file = _file;
+		_file = nullptr;
+		if(std::fclose(file) != 0) fail("[ERROR] Could not write \"" + _fileName + "\"");
+	};
+
+	/*
+	 * Returns true if a file couldn't be written, after which the sink doesn't write anymore. Safe to call from any thread
+	 */
+	bool hasFailed() const {
+		return _failed.load(std::memory_order_acquire);
+	};
+
+	/*
+	 * Returns the error that stopped the sink, or an empty string. Safe to call from any thread
+	 */
+	std::string getError() const {
+		return hasFailed() ? _error : std::string();
+	};
+
+	/*
+	 * Returns the number of trials written
+	 */
+	size_t getRecordCount() const {
+		return _records;
+	};
+
+	/*
+	 * Returns the options of the sink
+	 */
+	const QLLib::Utils::MetricsOptions& getOptions() const {
+		return _options;
+	};
+private:
+	static const size_t kMaxRecordBytes = 256;
+
+	/*
+	 * Records the first error and stops writing: the file is closed and the buffered stats are dropped
+	 */
+	void fail(const std::string &error) {
+		if(_file != nullptr) std::fclose(_file);
+		_file = nullptr;
+		_buffer.clear();
+		if(!_failed.load(std::memory_order_relaxed)) {
+			_error = error;
+			_failed.store(true, std::memory_order_release);
+		}
+	};
+
+	/*
+	 * Adds a record to the buffer, writing the buffer first if it's full and rotating the file if it's too large
+	 */
+	void append(const char *data, size_t size) {
+		if(_buffer.size() + size > _options.bufferBytes) flush();
+		if((_options.rotateBytes > 0) && (_fileBytes + _buffer.size() + size > _options.rotateBytes) && (_fileBytes + _buffer.size() > _headerBytes)) {
+			close();
+			_index++;
+			if(!_failed.load(std::memory_order_relaxed)) open();
+		}
+		if(_file != nullptr) _buffer.insert(_buffer.end(), data, data + size);
+	};
+
+	/*
+	 * Opens the next file and writes its header
+	 */
+	void open() {
+		bool csv = (_options.format == QLLib::Utils::MetricsFormat::CSV);
+		_fileName = _path;
+		if(_options.rotateBytes > 0) {
+			char suffix[16];
+			std::snprintf(suffix, sizeof(suffix), ".%04d", _index);
+			_fileName += suffix;
+		}
+		_fileName += csv ? ".csv" : ".bin";
+		_file = std::fopen(_fileName.c_str(), "wb");
+		if(_file == nullptr) {
+			fail("[ERROR] Could not open \"" + _fileName + "\" for writing");
+			return;
+		}
+		_fileBytes = 0;
+		if(csv) {
+			const char *header = "trialsCompleted,totalSteps,stepsPerTrial,rewardsPerTrial,maxDeltaQ,meanDeltaQ,policyChanges,truncated\n";
+			_buffer.insert(_buffer.end(), header, header + std::strlen(header));
+		} else {
+			// magic, version and record size, so readers can check the layout
+			char header[16] = "QLSTATS";
+			uint32_t version = 2;
+			uint32_t recordBytes = sizeof(QLLib::Utils::MetricsRecord);
+			std::memcpy(header + 8, &version, 4);
+			std::memcpy(header + 12, &recordBytes, 4);
+			_buffer.insert(_buffer.end(), header, header + sizeof(header));
+		}
+		_headerBytes = _buffer.size();
+	};
+
+	std::string _path;
+	std::string _fileName;
+	QLLib::Utils::MetricsOptions _options;
+	std::vector<char> _buffer;
+	std::FILE *_file = nullptr;
+	size_t _fileBytes = 0;
+	size_t _headerBytes = 0;
+	size_t _records = 0;
+	int _index = 0;
+	std::atomic<bool> _failed{false};
+	std::string _error;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLMETRICSSINK_H_ */
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLNotifier.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLNOTIFIER_H_
+#define QLNOTIFIER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "QLUtils.h"
+
+namespace QLLib {
+namespace Utils {
+
+/*
+ * OverflowPolicy Enum
+ * What the simulation does when a listener's queue is full
+ */
+enum class OverflowPolicy {
+	Block,	// wait until the notifier thread makes room (no stats are lost)
+	Drop	// discard the stats and keep learning
+};
+
+/*
+ * NotifierOptions Struct
+ * A utility struct to configure batched event delivery
+ */
+struct NotifierOptions {
+	// Deliver a batch every 'batchTrials' trials (0 disables count-based delivery)
+	int batchTrials = 1;
+	// Deliver a batch every 'batchMillis' milliseconds (0 disables time-based delivery)
+	int batchMillis = 0;
+	// Maximum number of stats waiting to be delivered
+	size_t queueCapacity = 1024;
+	OverflowPolicy overflow = OverflowPolicy::Block;
+	// Only queue the stats of one trial every 'sampleEvery' (1 queues all of them)
+	int sampleEvery = 1;
+};
+
+/*
+ * SPSCQueue Class
+ * A bounded, lock-free ring buffer for exactly one producer thread and one consumer thread
+ */
+template<class T>
+class SPSCQueue {
+public:
+	/*
+	 * SPSCQueue Constructor
+	 * \param capacity The maximum number of elements the queue can hold
+	 */
+	SPSCQueue(size_t capacity) : _buffer(capacity + 1), _head(0), _tail(0) {};
+
+	/*
+	 * Pushes an element, returns false if the queue is full (producer only)
+	 */
+	bool push(const T &value) {
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		size_t next = increment(tail);
+		if(next == _head.load(std::memory_order_acquire)) return false;
+		_buffer[tail] = value;
+		_tail.store(next, std::memory_order_release);
+		return true;
+	};
+
+	/*
+	 * Pops an element, returns false if the queue is empty (consumer only)
+	 */
+	bool pop(T &value) {
+		size_t head = _head.load(std::memory_order_relaxed);
+		if(head == _tail.load(std::memory_order_acquire)) return false;
+		value = _buffer[head];
+		_head.store(increment(head), std::memory_order_release);
+		return true;
+	};
+
+	bool empty() const {
+		return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+	};
+private:
+	size_t increment(size_t i) const {
+		return (i + 1 == _buffer.size()) ? 0 : i + 1;
+	};
+
+	std::vector<T> _buffer;
+	// head and tail are padded onto separate cache lines so producer and consumer don't false-share
+	char _padBefore[64];
+	std::atomic<size_t> _head;
+	char _padBetween[64];
+	std::atomic<size_t> _tail;
+};
+
+} /* namespace Utils */
+
+/*
+ * QLNotifier Class
+ * Delivers trial stats to a listener in batches, from a dedicated notifier thread.
+ * The simulation only pushes the stats into a bounded queue, so slow listeners never stall learning
+ * (unless the queue is full and the overflow policy is Block).
+ */
+class QLNotifier {
+public:
+	typedef std::function<void(const std::vector<QLLib::Utils::Stats>&)> BatchCallback;
+
+	/*
+	 * QLNotifier Constructor - starts the notifier thread
+	 * \param cb The callback function (lambda) that will receive each batch
+	 * \param options How and when batches are delivered
+	 */
+	QLNotifier(BatchCallback cb, QLLib::Utils::NotifierOptions options) :
+		_callback(cb), _options(options), _queue(options.queueCapacity > 0 ? options.queueCapacity : 1) {
+		// wake the notifier thread when a batch is ready, or before the queue fills up
+		size_t halfQueue = std::max<size_t>(1, (_options.queueCapacity + 1) / 2);
+		_wakeThreshold = 1;
+		if(_options.batchTrials > 1) {
+			_wakeThreshold = std::min<size_t>(_options.batchTrials, halfQueue);
+		} else if((_options.batchTrials <= 0) && (_options.batchMillis > 0)) {
+			// time-based delivery only: the wait's timeout delivers the batches
+			_wakeThreshold = halfQueue;
+		}
+		_thread = std::thread(&QLNotifier::run, this);
+	};
+
+	/*
+	 * QLNotifier Destructor - delivers any pending stats and joins the notifier thread
+	 */
+	virtual ~QLNotifier() {
+		close();
+	};
+
+	/*
+	 * Queues the stats of a finished trial (called from the simulation thread)
+	 * \param stats The stats of the trial
+	 */
+	void notify(const QLLib::Utils::Stats &stats) {
+		if((_options.sampleEvery > 1) && ((_sampled++ % _options.sampleEvery) != 0)) return;
+		if(!_queue.push(stats)) {
+			if(_options.overflow == QLLib::Utils::OverflowPolicy::Drop) {
+				_dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			while(!_queue.push(stats)) {
+				wake();
+				std::this_thread::yield();
+			}
+		}
+		if(++_pending >= _wakeThreshold) {
+			_pending = 0;
+			wake();
+		}
+	};
+
+	/*
+	 * Flushes the queue and stops the notifier thread
+	 */
+	void close() {
+		if(!_thread.joinable()) return;
+		_running.store(false);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_cv.notify_one();
+		}
+		_thread.join();
+	};
+
+	/*
+	 * Returns the number of stats discarded because the queue was full
+	 */
+	size_t getDroppedCount() const {
+		return _dropped.load(std::memory_order_relaxed);
+	};
+private:
+	void wake() {
+		if(_sleeping.load(std::memory_order_acquire)) _cv.notify_one();
+	};
+
+	/*
+	 * The notifier thread's loop
+	 */
+	void run() {
+		typedef std::chrono::steady_clock Clock;
+		std::vector<QLLib::Utils::Stats> batch;
+		if(_options.batchTrials > 0) batch.reserve(_options.batchTrials);
+		Clock::time_point lastDelivery = Clock::now();
+		// Wait at most this long between checks, so a missed wake-up only delays delivery
+		std::chrono::milliseconds idle(_options.batchMillis > 0 ? _options.batchMillis : 50);
+		QLLib::Utils::Stats stats;
+		for(;;) {
+			bool running = _running.load();
+			while(_queue.pop(stats)) {
+				batch.push_back(stats);
+				if((_options.batchTrials > 0) && (batch.size() >= (size_t) _options.batchTrials)) {
+					deliver(batch);
+					lastDelivery = Clock::now();
+				}
+			}
+			bool timeElapsed = (_options.batchMillis > 0) && (Clock::now() - lastDelivery >= idle);
+			bool noBatching = (_options.batchTrials <= 0) && (_options.batchMillis <= 0);
+			if(!batch.empty() && (timeElapsed || noBatching || !running)) {
+				deliver(batch);
+				lastDelivery = Clock::now();
+			}
+			if(!running) break;
+			std::unique_lock<std::mutex> lock(_mutex);
+			_sleeping.store(true, std::memory_order_release);
+			if(_queue.empty() && _running.load()) _cv.wait_for(lock, idle);
+			_sleeping.store(false, std::memory_order_release);
+		}
+	};
+
+	void deliver(std::vector<QLLib::Utils::Stats> &batch) {
+		_callback(batch);
+		batch.clear();
+	};
+
+	BatchCallback _callback;
+	QLLib::Utils::NotifierOptions _options;
+	QLLib::Utils::SPSCQueue<QLLib::Utils::Stats> _queue;
+	size_t _wakeThreshold;
+	size_t _pending = 0;
+	size_t _sampled = 0;
+	std::atomic<size_t> _dropped{0};
+	std::atomic<bool> _running{true};
+	std::atomic<bool> _sleeping{false};
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	std::thread _thread;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLNOTIFIER_H_ */
@@ -1,241 +1,545 @@
-/*
- * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *     http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- *
- * QLPolicy.h
- *
- *  Created on: Dec 16, 2015
- *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
- */
-
-#ifndef QLPOLICY_H_
-#define QLPOLICY_H_
-
-#include "QLAction.h"
-
-namespace QLLib {
-
-/*
- * QLPolicy Class
- * The QLPolicy class is an abstract class that represents a generic policy
- */
-class QLPolicy {
-public:
-	/*
-	 * QLPolicy Constructor
-	 */
-	QLPolicy() {};
-
-	virtual ~QLPolicy() {};
-
-	/*
-	 * Apply the policy to the provided Q-values and get the chosen action
-	 * \param Q An array of Q-values
-	 * \param count The size of Q
-	 */
-	virtual int sampleAction(double Q[], int count) = 0;
-};
-
-/*
- * NormalPolicy Class
- * This class represents the traditional policy (Greedy) for Q-learning algorithm
- */
-class NormalPolicy : public QLPolicy {
-public:
-	/*
-	 * NormalPolicy Constructor
-	 */
-	NormalPolicy() {};
-
-	virtual ~NormalPolicy() {};
-
-	/*
-	 * Apply the policy to the provided Q-values and get the best possible action (greedy)
-	 * \param Q An array of Q-values
-	 * \param count The size of Q
-	 */
-	virtual int sampleAction(double Q[], int count) {
-		if(QLLib::Utils::arrayValuesEqual(Q, count)) {
-			// all actions have same Q, choose randomly
-			return sampleRandomAction(count);
-		} else {
-			return getIndexOfLargestElement(Q, count);
-		}
-	};
-private:
-	/*
-	 * Samples a random action within the provided range
-	 */
-	int sampleRandomAction(int count) {
-		return Utils::iRand(0, count-1);
-	};
-
-	/*
-	 * Samples the best action based on the largest Q-value
-	 */
-	int getIndexOfLargestElement(double arr[], int size) {
-		int largestIndex = 0;
-		// TODO: Fix this, as it gives slightly polarized results when there are equal values
-		for (int index = largestIndex; index < size; index++) {
-			if (arr[largestIndex] < arr[index]) {
-				largestIndex = index;
-			}
-		}
-		return largestIndex;
-	}
-};
-
-/*
- * RandomPolicy Class
- */
-class RandomPolicy : public QLPolicy {
-public:
-	/*
-	 * RandomPolicy Constructor
-	 */
-	RandomPolicy() {};
-
-	virtual ~RandomPolicy() {};
-
-	/*
-	 * Samples a random action
-	 */
-	virtual int sampleAction(double Q[], int count) {
-		return sampleRandomAction(count);
-	};
-private:
-	/*
-	 * Samples a random action within the provided range
-	 */
-	int sampleRandomAction(int count) {
-		return Utils::iRand(0, count-1);
-	};
-};
-
-/*
- * EpsilonGreedyPolicy Class
- * This class implements the E-Greedy policy
- */
-class EpsilonGreedyPolicy : public QLPolicy {
-public:
-	/*
-	 * EpsilonGreedyPolicy Constructor
-	 */
-	EpsilonGreedyPolicy(double epsilon) : _epsilon(epsilon) {};
-
-	virtual ~EpsilonGreedyPolicy() {};
-
-	/*
-	 * Apply the policy to the provided Q-values and get the chosen action
-	 */
-	virtual int sampleAction(double Q[], int count) {
-		double probability = Utils::fRand(0.0, 1.0);
-		if(probability < _epsilon) {
-			// Choose random action
-			return sampleRandomAction(count);
-		} else {
-			// Choose action with best Q
-			return sampleBestAction(Q, count);
-		}
-	};
-private:
-	/*
-	 * Samples the best action possible
-	 */
-	int sampleBestAction(double Q[], int count) {
-		if(QLLib::Utils::arrayValuesEqual(Q, count)) {
-			// all actions have same Q, choose randomly
-			return sampleRandomAction(count);
-		} else {
-			return getIndexOfLargestElement(Q, count);
-		}
-	};
-
-	/*
-	 * Samples a random action
-	 */
-	int sampleRandomAction(int count) {
-		return Utils::iRand(0, count-1);
-	};
-
-	/*
-	 * Get action with largest Q
-	 */
-	int getIndexOfLargestElement(double arr[], int size) {
-		int largestIndex = 0;
-		// TODO: Fix this, as it gives slightly polarized results when there are equal values
-		for (int index = largestIndex; index < size; index++) {
-			if (arr[largestIndex] < arr[index]) {
-				largestIndex = index;
-			}
-		}
-		return largestIndex;
-	}
-
-	double _epsilon;
-};
-
-/*
- * SoftmaxPolicy Class
- * This class implements the Softmax policy
- */
-class SoftmaxPolicy : public QLPolicy {
-public:
-	/*
-	 * SoftmaxPolicy Constructor
-	 */
-	SoftmaxPolicy(double t) : _temperature(t) {};
-
-	virtual ~SoftmaxPolicy() {};
-
-	/*
-	 * Samples the best possible action based on the Softmax algorithm
-	 *
-	 * A = exp(Q/t) / E(exp(Q/t))
-	 *
-	 * A = chosen action
-	 * Q = Q-value for state-action
-	 * E = sum
-	 * t = temperature
-	 */
-	virtual int sampleAction(double Q[], int count) {
-		double pQ[count];
-		double totalP = 0.0;
-		// Calculate P of all actions
-		for(int i=0;i<count;i++) {
-			pQ[i] = exp(Q[i]/_temperature);
-			// Update sum of P
-			totalP+=pQ[i];
-		}
-		// Divide P by sum of all P
-		for(int i=0;i<count;i++) {
-			pQ[i] = pQ[i] / totalP;
-		}
-		// Randomly choose based on probability - http://stackoverflow.com/a/2649761
-		double p = (rand() / static_cast<double>(RAND_MAX)) * 1.0;
-		double* current = &pQ[0];
-		int index = 0;
-		while ((p -= *current) > 0) {
-		    ++current;
-		    index++;
-		}
-		return index;
-	};
-private:
-	double _temperature;
-};
-
-} /* namespace QLLib */
-
-#endif /* QLPOLICY_H_ */
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLPolicy.h
+ *
+ *  Created on: Dec 16, 2015
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLPOLICY_H_
+#define QLPOLICY_H_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "QLAction.h"
+
+namespace QLLib {
+
+/*
+ * QLPolicy Class
+ * The QLPolicy class is an abstract class that represents a generic policy
+ * Q-values can be doubles or floats, depending on the value type of the algorithm's Q-table (see QLLookupTable.h).
+ * A policy only has to implement the double version: the float versions convert the Q-values and call it.
+ * The policies in this file override both with the same templated code, so floats are never converted.
+ */
+class QLPolicy {
+public:
+	/*
+	 * QLPolicy Constructor
+	 */
+	QLPolicy() {};
+
+	virtual ~QLPolicy() {};
+
+	/*
+	 * Apply the policy to the provided Q-values and get the chosen action
+	 * Q points straight into the Q-table, so it must not be modified
+	 * \param Q An array of Q-values
+	 * \param count The size of Q
+	 */
+	virtual int sampleAction(double Q[], int count) = 0;
+
+	/*
+	 * Apply the policy to the provided single precision Q-values and get the chosen action
+	 */
+	virtual int sampleAction(float Q[], int count) {
+		return sampleAction(widen(Q, count), count);
+	};
+
+	/*
+	 * Apply the policy to the provided Q-values and visit counts and get the chosen action
+	 * Only called for policies that use visit counts (see usesVisitCounts()), the default ignores the counts
+	 * \param Q An array of Q-values
+	 * \param N The number of times each action was taken in the state
+	 * \param count The size of Q and N
+	 */
+	virtual int sampleAction(double Q[], const uint32_t N[], int count) {
+		return sampleAction(Q, count);
+	};
+
+	/*
+	 * Apply the policy to the provided single precision Q-values and visit counts and get the chosen action
+	 */
+	virtual int sampleAction(float Q[], const uint32_t N[], int count) {
+		return sampleAction(widen(Q, count), N, count);
+	};
+
+	/*
+	 * Returns true if the policy needs the visit counts of the state-action combinations.
+	 * The algorithm then keeps them next to its Q-table
+	 */
+	virtual bool usesVisitCounts() const {
+		return false;
+	};
+
+	/*
+	 * Apply the policy to a batch of Q-value arrays and get the chosen actions
+	 * Policies can override this with a tighter loop, the default samples each row with sampleAction()
+	 * \param rows The Q-values of each agent's state, each of size 'count'
+	 * \param count The number of actions
+	 * \param n The number of rows
+	 * \param actions The chosen action of each row
+	 */
+	virtual void sampleActions(double *const rows[], int count, int n, int actions[]) {
+		for(int i = 0; i < n; i++) {
+			actions[i] = sampleAction(rows[i], count);
+		}
+	};
+
+	/*
+	 * Apply the policy to a batch of single precision Q-value arrays and get the chosen actions
+	 */
+	virtual void sampleActions(float *const rows[], int count, int n, int actions[]) {
+		for(int i = 0; i < n; i++) {
+			actions[i] = sampleAction(rows[i], count);
+		}
+	};
+private:
+	double* widen(const float Q[], int count) {
+		_widened.resize(count);
+		for(int i = 0; i < count; i++) _widened[i] = Q[i];
+		return &_widened[0];
+	};
+
+	std::vector<double> _widened;
+};
+
+/*
+ * NormalPolicy Class
+ * This class represents the traditional policy (Greedy) for Q-learning algorithm
+ */
+class NormalPolicy : public QLPolicy {
+public:
+	using QLPolicy::sampleAction;
+
+	/*
+	 * NormalPolicy Constructor
+	 */
+	NormalPolicy() {};
+
+	virtual ~NormalPolicy() {};
+
+	/*
+	 * Apply the policy to the provided Q-values and get the best possible action (greedy)
+	 * \param Q An array of Q-values
+	 * \param count The size of Q
+	 */
+	virtual int sampleAction(double Q[], int count) {
+		return sample(Q, count);
+	};
+
+	virtual int sampleAction(float Q[], int count) {
+		return sample(Q, count);
+	};
+
+	/*
+	 * Apply the policy to a batch of Q-value arrays (greedy)
+	 */
+	virtual void sampleActions(double *const rows[], int count, int n, int actions[]) {
+		for(int i = 0; i < n; i++) {
+			actions[i] = sample(rows[i], count);
+		}
+	};
+
+	virtual void sampleActions(float *const rows[], int count, int n, int actions[]) {
+		for(int i = 0; i < n; i++) {
+			actions[i] = sample(rows[i], count);
+		}
+	};
+private:
+	template<class T>
+	int sample(const T Q[], int count) {
+		if(QLLib::Utils::arrayValuesEqual(Q, count)) {
+			// all actions have same Q, choose randomly
+			return sampleRandomAction(count);
+		} else {
+			return getIndexOfLargestElement(Q, count);
+		}
+	};
+
+	/*
+	 * Samples a random action within the provided range
+	 */
+	int sampleRandomAction(int count) {
+		return Utils::iRand(0, count-1);
+	};
+
+	/*
+	 * Samples the best action based on the largest Q-value
+	 */
+	template<class T>
+	int getIndexOfLargestElement(const T arr[], int size) {
+		// TODO: Fix this, as it gives slightly polarized results when there are equal values
+		return QLLib::Utils::indexOfLargest(arr, size);
+	}
+};
+
+/*
+ * RandomPolicy Class
+ */
+class RandomPolicy : public QLPolicy {
+public:
+	using QLPolicy::sampleAction;
+
+	/*
+	 * RandomPolicy Constructor
+	 */
+	RandomPolicy() {};
+
+	virtual ~RandomPolicy() {};
+
+	/*
+	 * Samples a random action
+	 */
+	virtual int sampleAction(double Q[], int count) {
+		return sampleRandomAction(count);
+	};
+
+	virtual int sampleAction(float Q[], int count) {
+		return sampleRandomAction(count);
+	};
+private:
+	/*
+	 * Samples a random action within the provided range
+	 */
+	int sampleRandomAction(int count) {
+		return Utils::iRand(0, count-1);
+	};
+};
+
+/*
+ * EpsilonGreedyPolicy Class
+ * This class implements the E-Greedy policy
+ */
+class EpsilonGreedyPolicy : public QLPolicy {
+public:
+	using QLPolicy::sampleAction;
+
+	/*
+	 * EpsilonGreedyPolicy Constructor
+	 */
+	EpsilonGreedyPolicy(double epsilon) : _epsilon(epsilon) {};
+
+	virtual ~EpsilonGreedyPolicy() {};
+
+	/*
+	 * Returns the probability of choosing a random action
+	 */
+	double getEpsilon() const {
+		return _epsilon;
+	};
+
+	/*
+	 * Sets the probability of choosing a random action
+	 */
+	void setEpsilon(double epsilon) {
+		_epsilon = epsilon;
+	};
+
+	/*
+	 * Apply the policy to the provided Q-values and get the chosen action
+	 */
+	virtual int sampleAction(double Q[], int count) {
+		return sample(Q, count);
+	};
+
+	virtual int sampleAction(float Q[], int count) {
+		return sample(Q, count);
+	};
+
+	/*
+	 * Apply the policy to a batch of Q-value arrays
+	 */
+	virtual void sampleActions(double *const rows[], int count, int n, int actions[]) {
+		for(int i = 0; i < n; i++) {
+			actions[i] = sample(rows[i], count);
+		}
+	};
+
+	virtual void sampleActions(float *const rows[], int count, int n, int actions[]) {
+		for(int i = 0; i < n; i++) {
+			actions[i] = sample(rows[i], count);
+		}
+	};
+private:
+	template<class T>
+	int sample(const T Q[], int count) {
+		double probability = Utils::fRand(0.0, 1.0);
+		if(probability < _epsilon) {
+			// Choose random action
+			return sampleRandomAction(count);
+		} else {
+			// Choose action with best Q
+			return sampleBestAction(Q, count);
+		}
+	};
+
+	/*
+	 * Samples the best action possible
+	 */
+	template<class T>
+	int sampleBestAction(const T Q[], int count) {
+		if(QLLib::Utils::arrayValuesEqual(Q, count)) {
+			// all actions have same Q, choose randomly
+			return sampleRandomAction(count);
+		} else {
+			return getIndexOfLargestElement(Q, count);
+		}
+	};
+
+	/*
+	 * Samples a random action
+	 */
+	int sampleRandomAction(int count) {
+		return Utils::iRand(0, count-1);
+	};
+
+	/*
+	 * Get action with largest Q
+	 */
+	template<class T>
+	int getIndexOfLargestElement(const T arr[], int size) {
+		// TODO: Fix this, as it gives slightly polarized results when there are equal values
+		return QLLib::Utils::indexOfLargest(arr, size);
+	}
+
+	double _epsilon;
+};
+
+/*
+ * SoftmaxPolicy Class
+ * This class implements the Softmax policy
+ */
+class SoftmaxPolicy : public QLPolicy {
+public:
+	using QLPolicy::sampleAction;
+
+	/*
+	 * SoftmaxPolicy Constructor
+	 */
+	SoftmaxPolicy(double t) : _temperature(t) {};
+
+	virtual ~SoftmaxPolicy() {};
+
+	/*
+	 * Returns the temperature
+	 */
+	double getTemperature() const {
+		return _temperature;
+	};
+
+	/*
+	 * Sets the temperature (higher temperatures make the choice more random)
+	 */
+	void setTemperature(double t) {
+		_temperature = t;
+	};
+
+	/*
+	 * Samples the best possible action based on the Softmax algorithm
+	 *
+	 * A = exp(Q/t) / E(exp(Q/t))
+	 *
+	 * A = chosen action
+	 * Q = Q-value for state-action
+	 * E = sum
+	 * t = temperature
+	 */
+	virtual int sampleAction(double Q[], int count) {
+		return sample(Q, count);
+	};
+
+	virtual int sampleAction(float Q[], int count) {
+		return sample(Q, count);
+	};
+private:
+	template<class T>
+	int sample(const T Q[], int count) {
+		double pQ[count];
+		double totalP = 0.0;
+		// Calculate P of all actions
+		for(int i=0;i<count;i++) {
+			pQ[i] = exp(Q[i]/_temperature);
+			// Update sum of P
+			totalP+=pQ[i];
+		}
+		// Divide P by sum of all P
+		for(int i=0;i<count;i++) {
+			pQ[i] = pQ[i] / totalP;
+		}
+		// Randomly choose based on probability - http://stackoverflow.com/a/2649761
+		double p = Utils::uniformRand();
+		double* current = &pQ[0];
+		int index = 0;
+		while (((p -= *current) > 0) && (index < count - 1)) {
+		    ++current;
+		    index++;
+		}
+		return index;
+	};
+
+	double _temperature;
+};
+
+/*
+ * UCBPolicy Class
+ * This class implements the UCB1 policy (https://homes.di.unimi.it/~cesabian/Pubblicazioni/ml-02.pdf):
+ * actions that were never taken in a state are tried first, then the chosen action is the one with the best upper confidence bound
+ *
+ * A = argmax(Q(S,a) + c * sqrt(ln(N(S)) / N(S,a)))
+ *
+ * N(S,a) = number of times action a was taken in state S
+ * N(S) = sum of N(S,a)
+ * c = exploration constant
+ */
+class UCBPolicy : public QLPolicy {
+public:
+	/*
+	 * UCBPolicy Constructor
+	 * \param c The exploration constant (sqrt(2) in the original UCB1)
+	 */
+	UCBPolicy(double c = 1.4142135623730951) : _c(c) {};
+
+	virtual ~UCBPolicy() {};
+
+	/*
+	 * Without visit counts the policy is greedy
+	 */
+	virtual int sampleAction(double Q[], int count) {
+		return QLLib::Utils::indexOfLargest(Q, count);
+	};
+
+	virtual int sampleAction(float Q[], int count) {
+		return QLLib::Utils::indexOfLargest(Q, count);
+	};
+
+	/*
+	 * Apply the policy to the provided Q-values and visit counts and get the chosen action
+	 */
+	virtual int sampleAction(double Q[], const uint32_t N[], int count) {
+		return sample(Q, N, count);
+	};
+
+	virtual int sampleAction(float Q[], const uint32_t N[], int count) {
+		return sample(Q, N, count);
+	};
+
+	virtual bool usesVisitCounts() const {
+		return true;
+	};
+
+	/*
+	 * Sets the exploration constant
+	 */
+	void setExplorationConstant(double c) {
+		_c = c;
+	};
+private:
+	template<class T>
+	int sample(const T Q[], const uint32_t N[], int count) {
+		// the first pass only reads integers: find the total and any untried action
+		uint64_t total = 0;
+		int untried = -1;
+		for(int i = 0; i < count; i++) {
+			total += N[i];
+			if((N[i] == 0) && (untried < 0)) untried = i;
+		}
+		if(untried >= 0) return untried;
+		// the scoring loop has no branches, so the compiler can vectorize it
+		_scores.resize(count);
+		double *scores = &_scores[0];
+		double c2LogTotal = _c * _c * std::log(static_cast<double>(total));
+		for(int i = 0; i < count; i++) {
+			scores[i] = Q[i] + std::sqrt(c2LogTotal / N[i]);
+		}
+		return QLLib::Utils::indexOfLargest(scores, count);
+	};
+
+	double _c;
+	std::vector<double> _scores;
+};
+
+/*
+ * CountBonusPolicy Class
+ * This class implements count-based exploration: each action gets a bonus that shrinks with the number of times
+ * it was taken in the state, and the chosen action is the one with the best bonus-adjusted Q-value
+ *
+ * A = argmax(Q(S,a) + beta / sqrt(N(S,a) + 1))
+ *
+ * beta = the size of the bonus (use a value in the scale of the rewards)
+ */
+class CountBonusPolicy : public QLPolicy {
+public:
+	/*
+	 * CountBonusPolicy Constructor
+	 * \param beta The size of the bonus
+	 */
+	CountBonusPolicy(double beta) : _beta(beta) {};
+
+	virtual ~CountBonusPolicy() {};
+
+	/*
+	 * Without visit counts the policy is greedy
+	 */
+	virtual int sampleAction(double Q[], int count) {
+		return QLLib::Utils::indexOfLargest(Q, count);
+	};
+
+	virtual int sampleAction(float Q[], int count) {
+		return QLLib::Utils::indexOfLargest(Q, count);
+	};
+
+	/*
+	 * Apply the policy to the provided Q-values and visit counts and get the chosen action
+	 */
+	virtual int sampleAction(double Q[], const uint32_t N[], int count) {
+		return sample(Q, N, count);
+	};
+
+	virtual int sampleAction(float Q[], const uint32_t N[], int count) {
+		return sample(Q, N, count);
+	};
+
+	virtual bool usesVisitCounts() const {
+		return true;
+	};
+
+	/*
+	 * Sets the size of the bonus
+	 */
+	void setBeta(double beta) {
+		_beta = beta;
+	};
+private:
+	template<class T>
+	int sample(const T Q[], const uint32_t N[], int count) {
+		// the scoring loop has no branches, so the compiler can vectorize it
+		_scores.resize(count);
+		double *scores = &_scores[0];
+		for(int i = 0; i < count; i++) {
+			scores[i] = Q[i] + _beta / std::sqrt(N[i] + 1.0);
+		}
+		return QLLib::Utils::indexOfLargest(scores, count);
+	};
+
+	double _beta;
+	std::vector<double> _scores;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLPOLICY_H_ */
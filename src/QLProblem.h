@@ -1,147 +1,549 @@
-/*
- * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *     http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- *
- * QLProblem.h
- *
- *  Created on: Dec 15, 2015
- *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
- */
-
-#ifndef QLPROBLEM_H_
-#define QLPROBLEM_H_
-
-#include <iostream>
-#include <vector>
-#include <cstdlib>
-#include "QLAgent.h"
-#include "QLUtils.h"
-#include "QLAlgorithm.h"
-
-namespace QLLib {
-
-/*
- * QLProblem Class
- * The QLProblem class represents the model of a Q-learning problem
- */
-class QLProblem {
-	friend class QL;
-public:
-	/*
-	 * QLProblem Constructor
-	 */
-	QLProblem() {
-		_agent = new QLLib::QLAgent();
-		_algorithm = nullptr;
-	};
-
-	/*
-	 * QLProblem Destructor
-	 */
-	virtual ~QLProblem() {
-		for(auto i:_states) delete i;
-		for(auto i:_actions) delete i;
-		delete _algorithm;
-		delete _agent;
-	};
-
-	/*
-	 * Gets a vector of all available states
-	 */
-	std::vector<QLLib::QLState*> getAllStates() {
-		return _states;
-	};
-
-	/*
-	 * Get a vector of all available actions
-	 */
-	std::vector<QLLib::QLAction*> getAllActions() {
-		return _actions;
-	};
-
-	/*
-	 * Returns a pointer to the agent
-	 */
-	QLLib::QLAgent* getAgent() {
-		return _agent;
-	};
-
-	/*
-	 * Returns a pointer to the chosen algorithm
-	 */
-	QLLib::QLAlgorithm* getAlgorithm() {
-		if(_algorithm == nullptr) {
-			_algorithm = new QLLib::QLearningAlgorithm(0.0, 0.2, 0.9);
-			std::cout << "[WARNING] No algorithm specified, defaulting to QLearningAlgorithm" << std::endl;
-		}
-		return _algorithm;
-	};
-
-	/*
-	 * Sets the algorithm for the problem
-	 */
-	void setAlgorithm(QLLib::QLAlgorithm *a) {
-		_algorithm = a;
-	};
-protected:
-	/*
-	 * Adds a state to the states vector
-	 */
-	void addState(QLLib::QLState *s) {
-		_states.push_back(s);
-	};
-
-	/*
-	 * Adds an action to the actions vector
-	 */
-	void addAction(QLLib::QLAction *a) {
-		_actions.push_back(a);
-	};
-
-	/*
-	 * Returns a pointer to a QLState searching by name
-	 */
-	QLLib::QLState* getStateByName(std::string name) {
-		QLLib::QLState *s = nullptr;
-		for(auto i : _states) {
-			if(i->getName() == name) return i;
-		}
-		if(s == nullptr) {
-			std::cout << "[ERROR] Could not find state \"" << name << "\"" << std::endl;
-			exit(1);
-		}
-		return s;
-	};
-private:
-	void init() {
-		setupStates();
-		setupActions();
-		setupAlgorithm();
-		getAlgorithm()->init(getAllStates(), getAllActions());
-	};
-	virtual void setupStates() = 0;
-	virtual void setupActions() = 0;
-	virtual void setupAlgorithm() = 0;
-	virtual bool step() = 0;
-	virtual double reward() = 0;
-	virtual void endOfTrial() = 0;
-	std::vector<QLLib::QLState*> _states;
-	std::vector<QLLib::QLAction*> _actions;
-	QLLib::QLAgent *_agent;
-	QLLib::QLAlgorithm *_algorithm;
-};
-
-} /* namespace QLLib */
-
-#endif /* QLPROBLEM_H_ */
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLProblem.h
+ *
+ *  Created on: Dec 15, 2015
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLPROBLEM_H_
+#define QLPROBLEM_H_
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "QLAgent.h"
+#include "QLActionMask.h"
+#include "QLArena.h"
+#include "QLStateSpace.h"
+#include "QLUtils.h"
+#include "QLAlgorithm.h"
+
+namespace QLLib {
+
+/*
+ * QLProblem Class
+ * The QLProblem class represents the model of a Q-learning problem
+ */
+class QLProblem {
+	template<class Problem, class Algorithm> friend class BasicQL;
+public:
+	/*
+	 * QLProblem Constructor
+	 */
+	QLProblem() {
+		_agents.push_back(new QLLib::QLAgent());
+		_agentAlgorithms.push_back(nullptr);
+		_algorithm = nullptr;
+	};
+
+	/*
+	 * QLProblem Destructor
+	 */
+	virtual ~QLProblem() {
+		// States and actions created with emplaceState()/emplaceAction() are released by the arena
+		for(auto i:_heapStates) delete i;
+		for(auto i:_heapActions) delete i;
+		for(auto i:_agentAlgorithms) delete i;
+		for(auto i:_agents) delete i;
+		delete _algorithm;
+	};
+
+	/*
+	 * Gets a vector of all available states
+	 */
+	const std::vector<QLLib::QLState*>& getAllStates() const {
+		return _states;
+	};
+
+	/*
+	 * Get a vector of all available actions
+	 */
+	const std::vector<QLLib::QLAction*>& getAllActions() const {
+		return _actions;
+	};
+
+	/*
+	 * Returns the valid actions of every state, if the problem masks actions (see setActionMasking())
+	 */
+	const QLLib::QLActionMask& getActionMask() const {
+		return _actionMask;
+	};
+
+	/*
+	 * Returns a pointer to the agent
+	 * When the problem has several agents, this is the agent being stepped by the simulation
+	 * (so actions, step() and reward() always refer to the right agent), or the first agent outside the simulation loop
+	 */
+	QLLib::QLAgent* getAgent() {
+		return _agents[_activeAgent];
+	};
+
+	/*
+	 * Returns a pointer to an agent
+	 * \param index The index of the agent, in the order the agents were added (the problem's own agent is 0)
+	 */
+	QLLib::QLAgent* getAgent(int index) {
+		return _agents[index];
+	};
+
+	/*
+	 * Returns the number of agents
+	 */
+	int getAgentCount() const {
+		return _agents.size();
+	};
+
+	/*
+	 * Returns the index of the agent being stepped by the simulation
+	 */
+	int getActiveAgentIndex() const {
+		return _activeAgent;
+	};
+
+	/*
+	 * Returns a pointer to the algorithm that drives an agent:
+	 * the agent's own algorithm, or the problem's algorithm if the agent shares it
+	 * \param index The index of the agent
+	 */
+	QLLib::QLAlgorithm* getAgentAlgorithm(int index) {
+		if(_agentAlgorithms[index] != nullptr) return _agentAlgorithms[index];
+		return getAlgorithm();
+	};
+
+	/*
+	 * Returns a pointer to the chosen algorithm
+	 */
+	QLLib::QLAlgorithm* getAlgorithm() {
+		if(_algorithm == nullptr) {
+			_algorithm = new QLLib::QLearningAlgorithm(0.0, 0.2, 0.9);
+			std::cout << "[WARNING] No algorithm specified, defaulting to QLearningAlgorithm" << std::endl;
+		}
+		return _algorithm;
+	};
+
+	/*
+	 * Sets the algorithm for the problem
+	 */
+	void setAlgorithm(QLLib::QLAlgorithm *a) {
+		_algorithm = a;
+	};
+
+	/*
+	 * Returns the bytes used by the problem (its states, actions and indices) and by its algorithms' Q-tables and visit counts.
+	 * States and actions created with 'new' are counted as QLState and QLAction objects, so subclasses with more members
+	 * take more than reported; the ones created with emplaceState()/emplaceAction() are counted as the arena's blocks.
+	 * Hash maps are estimated from their number of buckets and elements
+	 */
+	QLLib::Utils::MemoryReport getMemoryUsage() {
+		QLLib::Utils::MemoryReport report;
+		report.states = (_states.capacity() + _heapStates.capacity()) * sizeof(QLLib::QLState*) + _heapStates.size() * sizeof(QLLib::QLState);
+		for(auto i : _states) report.states += stringBytes(i->getName());
+		report.actions = (_actions.capacity() + _heapActions.capacity()) * sizeof(QLLib::QLAction*) + _heapActions.size() * sizeof(QLLib::QLAction);
+		for(auto i : _actions) report.actions += stringBytes(i->getName());
+		report.arena = _arena.bytesReserved();
+		report.index = hashMapBytes(_stateNames) + hashMapBytes(_stateKeys) + _denseStates.capacity() * sizeof(QLLib::QLState*);
+		report.actions += _actionMask.getMemoryUsage();
+		if(_algorithm != nullptr) report.merge(_algorithm->getMemoryUsage());
+		for(auto i : _agentAlgorithms) {
+			if(i != nullptr) report.merge(i->getMemoryUsage());
+		}
+		return report;
+	};
+
+	/*
+	 * Predicts the bytes a problem would use, without allocating anything (i.e. to choose a Q-table before an out-of-memory)
+	 * Table, State and Action are the types of the Q-table, of the states and of the actions,
+	 * i.e. QLProblem::estimateMemory<QLLib::QLFloat16Table, MyState>(1000000, 8)
+	 * \param states The number of states
+	 * \param actions The number of actions
+	 * \param keyed True if the states have keys and the problem doesn't declare a state space (keys are then hashed)
+	 * \param visitCounts True if the algorithm counts visits (i.e. for count-based learning rates or UCB policies)
+	 */
+	template<class Table, class State = QLLib::QLState, class Action = QLLib::QLAction>
+	static QLLib::Utils::MemoryReport estimateMemory(size_t states, size_t actions, bool keyed = false, bool visitCounts = false) {
+		QLLib::Utils::MemoryReport report;
+		// the object, its pointer in the states vector and its owner's pointer (or the arena's record)
+		report.states = states * (sizeof(State) + 2 * sizeof(QLLib::QLState*));
+		report.actions = actions * (sizeof(Action) + 2 * sizeof(QLLib::QLAction*));
+		report.index = hashMapBytes<std::string, QLLib::QLState*>(states);
+		if(keyed) report.index += hashMapBytes<QLLib::QLStateKey, QLLib::QLState*>(states);
+		report.table = Table::estimateMemory(states, actions);
+		if(visitCounts) report.visits = QLLib::QLVisitTable::estimateMemory(states, actions);
+		return report;
+	};
+protected:
+	/*
+	 * Adds an agent to the problem. All agents are stepped once per tick of the simulation, in the order they were added,
+	 * and each one has its own current state, previous state and last action (set its initial state in setupStates()).
+	 * Agents that share the problem's algorithm also share its Q-table, so they all learn from each other's experience
+	 * and the table is stored once. Agents with their own algorithm learn independently.
+	 * The problem takes ownership of the agent and of its algorithm.
+	 * \param algorithm The agent's own algorithm, or nullptr to share the problem's algorithm
+	 */
+	QLLib::QLAgent* addAgent(QLLib::QLAlgorithm *algorithm = nullptr) {
+		QLLib::QLAgent *agent = new QLLib::QLAgent();
+		_agents.push_back(agent);
+		_agentAlgorithms.push_back(algorithm);
+		return agent;
+	};
+
+	/*
+	 * Adds a state to the states vector
+	 * The problem takes ownership of the state and deletes it when it's destroyed
+	 */
+	void addState(QLLib::QLState *s) {
+		_heapStates.push_back(s);
+		registerState(s);
+	};
+
+	/*
+	 * Creates a state of type T in the problem's arena and adds it to the states vector.
+	 * Prefer this to addState() for large problems: states are laid out contiguously in creation order,
+	 * creating one doesn't call the system allocator and they are all released at once.
+	 * \param args The arguments passed to T's constructor
+	 */
+	template<class T, class... Args>
+	T* emplaceState(Args&&... args) {
+		T *s = _arena.create<T>(std::forward<Args>(args)...);
+		registerState(s);
+		return s;
+	};
+
+	/*
+	 * Adds an action to the actions vector
+	 * The problem takes ownership of the action and deletes it when it's destroyed
+	 */
+	void addAction(QLLib::QLAction *a) {
+		_heapActions.push_back(a);
+		registerAction(a);
+	};
+
+	/*
+	 * Creates an action of type T in the problem's arena and adds it to the actions vector
+	 * \param args The arguments passed to T's constructor
+	 */
+	template<class T = QLLib::QLAction, class... Args>
+	T* emplaceAction(Args&&... args) {
+		T *a = _arena.create<T>(std::forward<Args>(args)...);
+		registerAction(a);
+		return a;
+	};
+
+	/*
+	 * Returns a pointer to a QLState searching by name
+	 * Throws std::out_of_range if there is no such state
+	 */
+	QLLib::QLState* getStateByName(const std::string &name) {
+		QLLib::QLState *s = findStateByName(name);
+		if(s == nullptr) {
+			throw std::out_of_range("[ERROR] Could not find state \"" + name + "\"");
+		}
+		return s;
+	};
+
+	/*
+	 * Returns a pointer to a QLState searching by name, or nullptr if there is no such state
+	 */
+	QLLib::QLState* findStateByName(const std::string &name) {
+		auto i = _stateNames.find(name);
+		return (i != _stateNames.end()) ? i->second : nullptr;
+	};
+
+	/*
+	 * Returns a pointer to a QLState searching by key, i.e. getStateByKey({x, y})
+	 * Throws std::out_of_range if there is no such state
+	 */
+	QLLib::QLState* getStateByKey(const QLLib::QLStateKey &key) {
+		QLLib::QLState *s = findStateByKey(key);
+		if(s == nullptr) {
+			std::string name;
+			for(int i = 0; i < key.size(); i++) name += (i > 0 ? "," : "") + QLLib::Utils::itos(key[i]);
+			throw std::out_of_range("[ERROR] Could not find state with key {" + name + "}");
+		}
+		return s;
+	};
+
+	/*
+	 * Returns a pointer to a QLState searching by key, or nullptr if there is no such state
+	 * If the problem declared a state space this is a bounds check, a few multiplications and an array read.
+	 * If states are created on demand, a missing state is created with createState()
+	 */
+	QLLib::QLState* findStateByKey(const QLLib::QLStateKey &key) {
+		QLLib::QLState *s = nullptr;
+		if(useDenseIndex()) {
+			size_t index = _stateSpace.encode(key);
+			if((index != QLLib::QLStateSpace::npos) && (index < _denseStates.size())) s = _denseStates[index];
+		} else {
+			auto i = _stateKeys.find(key);
+			if(i != _stateKeys.end()) s = i->second;
+		}
+		if((s == nullptr) && _statesOnDemand) s = materializeState(key);
+		return s;
+	};
+
+	/*
+	 * Returns a pointer to a QLState searching by its index in the state space, or nullptr if there is no such state
+	 * \param index The index of the state, as returned by getStateSpace().encode() or getStateSpace().neighbour()
+	 */
+	QLLib::QLState* findStateByIndex(size_t index) {
+		if(useDenseIndex()) {
+			return (index < _denseStates.size()) ? _denseStates[index] : nullptr;
+		}
+		if(index < _stateSpace.size()) return findStateByKey(_stateSpace.decode(index));
+		return nullptr;
+	};
+
+	/*
+	 * Declares the ranges of the states' keys (i.e. setStateSpace(QLLib::QLStateSpace({{1, 10}, {1, 10}})))
+	 * Keys are then mapped to states through a dense array instead of a hash map.
+	 * Call this in setupStates(), before adding states.
+	 * \param space The state space
+	 */
+	void setStateSpace(const QLLib::QLStateSpace &space) {
+		_stateSpace = space;
+		rebuildKeyIndex();
+	};
+
+	/*
+	 * Returns the state space declared by the problem (empty if there isn't one)
+	 */
+	const QLLib::QLStateSpace& getStateSpace() const {
+		return _stateSpace;
+	};
+
+	/*
+	 * Creates states on demand: instead of adding every state in setupStates(), the problem only adds
+	 * the states it needs up front (or none), and the others are created by createState() the first time
+	 * they are looked up by key. Memory and startup time then grow with the number of visited states.
+	 * If a state space is declared, only keys inside it are created; the space's size is never allocated.
+	 * \param onDemand True to create states on demand
+	 */
+	void setStatesOnDemand(bool onDemand) {
+		_statesOnDemand = onDemand;
+		rebuildKeyIndex();
+	};
+
+	/*
+	 * Returns true if states are created on demand (see setStatesOnDemand())
+	 */
+	bool isStatesOnDemand() const {
+		return _statesOnDemand;
+	};
+
+	/*
+	 * Declares how many states and actions the problem expects, so their storage is allocated once:
+	 * the states vector and indices are sized now, and the algorithms' Q-tables and visit counts after they're initialized
+	 * (which matters when states are created on demand, otherwise the tables are sized exactly).
+	 * Call this at the start of setupStates(), after setStateSpace()
+	 * \param states The number of states expected
+	 * \param actions The number of actions expected (0 if unknown)
+	 */
+	void setExpectedCounts(size_t states, size_t actions = 0) {
+		_expectedStates = states;
+		_states.reserve(states);
+		_stateNames.reserve(states);
+		if(!useDenseIndex()) _stateKeys.reserve(states);
+		_actions.reserve(actions);
+	};
+
+	/*
+	 * Masks the actions that aren't valid in a state (i.e. moving into a wall): the algorithms' policies only choose
+	 * among the valid actions, and only the valid actions are considered for the largest Q-value of a state,
+	 * so invalid actions don't waste steps and don't need a penalty to be learned.
+	 * The valid actions of each state are asked once to getValidActions(), when the problem is initialized
+	 * (or when a state is created on demand), and stored in a QLActionMask.
+	 * A state without valid actions is terminal: step() must end the trial when the agent reaches it.
+	 * Call this in setupStates() or setupActions()
+	 * \param masking True to mask actions
+	 */
+	void setActionMasking(bool masking) {
+		_actionMasking = masking;
+	};
+
+	/*
+	 * Returns the actions that are valid in a state, when the problem masks actions (see setActionMasking()).
+	 * By default all actions are valid
+	 * \param state The state
+	 * \param valid Output: the valid actions (empty when called)
+	 */
+	virtual void getValidActions(const QLLib::QLState *state, std::vector<QLLib::QLAction*> &valid) {
+		valid = _actions;
+	};
+private:
+	/*
+	 * Returns the bytes a string allocates outside of its object
+	 */
+	static size_t stringBytes(const std::string &s) {
+		return (s.capacity() > std::string().capacity()) ? s.capacity() + 1 : 0;
+	};
+
+	/*
+	 * Returns the bytes of a hash map: a pointer per bucket, and a node per element
+	 * (the element, a pointer to the next node and the cached hash)
+	 */
+	template<class Map>
+	static size_t hashMapBytes(const Map &map) {
+		return map.bucket_count() * sizeof(void*) + map.size() * (sizeof(typename Map::value_type) + sizeof(void*) + sizeof(size_t));
+	};
+
+	/*
+	 * Returns the bytes of a hash map of 'elements' elements, with about one bucket per element
+	 */
+	template<class Key, class Value>
+	static size_t hashMapBytes(size_t elements) {
+		return elements * (2 * sizeof(void*) + sizeof(std::pair<const Key, Value>) + sizeof(size_t));
+	};
+
+	void registerState(QLLib::QLState *s) {
+		s->_id = _states.size();
+		_states.push_back(s);
+		// index the state, the first state added with a given name or key wins
+		_stateNames.insert(std::make_pair(s->getName(), s));
+		if(!s->getKey().empty()) indexStateKey(s);
+		// states created on demand get their valid actions right away, the others when the problem is initialized
+		if(_actionMaskReady && (_actionMask.getStateCount() == static_cast<size_t>(s->_id))) addValidActions(s);
+	};
+
+	/*
+	 * Adds the valid actions of a state to the action mask
+	 */
+	void addValidActions(const QLLib::QLState *s) {
+		_validActions.clear();
+		getValidActions(s, _validActions);
+		_validIds.clear();
+		for(auto i : _validActions) _validIds.push_back(i->getId());
+		std::sort(_validIds.begin(), _validIds.end());
+		_validIds.erase(std::unique(_validIds.begin(), _validIds.end()), _validIds.end());
+		_actionMask.addState(_validIds.empty() ? nullptr : &_validIds[0], _validIds.size());
+	};
+
+	void indexStateKey(QLLib::QLState *s) {
+		if(!_stateSpace.empty() && !_stateSpace.contains(s->getKey())) {
+			throw std::out_of_range("[ERROR] The key of state \"" + s->getName() + "\" is outside the problem's state space");
+		}
+		if(useDenseIndex()) {
+			if(_denseStates.empty()) _denseStates.assign(_stateSpace.size(), nullptr);
+			size_t index = _stateSpace.encode(s->getKey());
+			if(_denseStates[index] == nullptr) _denseStates[index] = s;
+		} else {
+			_stateKeys.insert(std::make_pair(s->getKey(), s));
+		}
+	};
+
+	/*
+	 * Keys are indexed in a dense array when the problem declares a state space and all states are known,
+	 * otherwise in a hash map (so that on-demand problems don't allocate the whole space)
+	 */
+	bool useDenseIndex() const {
+		return !_stateSpace.empty() && !_statesOnDemand;
+	};
+
+	void rebuildKeyIndex() {
+		_stateKeys.clear();
+		std::vector<QLLib::QLState*>().swap(_denseStates);
+		for(auto i : _states) {
+			if(!i->getKey().empty()) indexStateKey(i);
+		}
+	};
+
+	QLLib::QLState* materializeState(const QLLib::QLStateKey &key) {
+		if(!_stateSpace.empty() && !_stateSpace.contains(key)) return nullptr;
+		QLLib::QLState *s = createState(key);
+		if(s == nullptr) return nullptr;
+		if(s->getKey() != key) {
+			throw std::logic_error("[ERROR] createState() must return a state with the requested key");
+		}
+		// states created with 'new' still need to be added
+		if(s->getId() < 0) addState(s);
+		return s;
+	};
+
+	void registerAction(QLLib::QLAction *a) {
+		a->_id = _actions.size();
+		_actions.push_back(a);
+	};
+
+	void init() {
+		setupStates();
+		setupActions();
+		setupAlgorithm();
+		if(_actionMasking) {
+			for(size_t i = _actionMask.getStateCount(); i < _states.size(); i++) addValidActions(_states[i]);
+			_actionMaskReady = true;
+			getAlgorithm()->setActionMask(&_actionMask);
+			for(auto i : _agentAlgorithms) {
+				if(i != nullptr) i->setActionMask(&_actionMask);
+			}
+		}
+		getAlgorithm()->init(getAllStates(), getAllActions());
+		for(auto i : _agentAlgorithms) {
+			if(i != nullptr) i->init(getAllStates(), getAllActions());
+		}
+		if(_expectedStates > _states.size()) {
+			getAlgorithm()->reserve(_expectedStates);
+			for(auto i : _agentAlgorithms) {
+				if(i != nullptr) i->reserve(_expectedStates);
+			}
+		}
+	};
+
+	void selectAgent(int index) {
+		_activeAgent = index;
+	};
+	virtual void setupStates() = 0;
+	virtual void setupActions() = 0;
+	virtual void setupAlgorithm() = 0;
+	/*
+	 * Creates the state with the given key, when states are created on demand (see setStatesOnDemand()).
+	 * Return a state with that key, created with emplaceState() or 'new', or nullptr if the key isn't a valid state
+	 */
+	virtual QLLib::QLState* createState(const QLLib::QLStateKey&) {
+		return nullptr;
+	};
+	virtual bool step() = 0;
+	virtual double reward() = 0;
+	virtual void endOfTrial() = 0;
+	std::vector<QLLib::QLState*> _states;
+	std::vector<QLLib::QLAction*> _actions;
+	std::vector<QLLib::QLState*> _heapStates;
+	std::unordered_map<std::string, QLLib::QLState*> _stateNames;
+	std::unordered_map<QLLib::QLStateKey, QLLib::QLState*, QLLib::QLStateKeyHash> _stateKeys;
+	QLLib::QLStateSpace _stateSpace;
+	std::vector<QLLib::QLState*> _denseStates;
+	bool _statesOnDemand = false;
+	size_t _expectedStates = 0;
+	bool _actionMasking = false;
+	bool _actionMaskReady = false;
+	QLLib::QLActionMask _actionMask;
+	std::vector<QLLib::QLAction*> _validActions;
+	std::vector<int> _validIds;
+	std::vector<QLLib::QLAction*> _heapActions;
+	QLLib::QLArena _arena;
+	std::vector<QLLib::QLAgent*> _agents;
+	std::vector<QLLib::QLAlgorithm*> _agentAlgorithms;
+	int _activeAgent = 0;
+	QLLib::QLAlgorithm *_algorithm;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLPROBLEM_H_ */
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLSchedule.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLSCHEDULE_H_
+#define QLSCHEDULE_H_
+
+#include <cmath>
+
+namespace QLLib {
+
+/*
+ * QLSchedule Class
+ * The QLSchedule class is an abstract class that represents how a parameter (i.e. alpha or epsilon)
+ * changes over time. Time is counted in trials or in steps.
+ */
+class QLSchedule {
+public:
+	enum Unit {
+		PerTrial,	// the value changes at the start of each trial
+		PerStep		// the value changes at each step
+	};
+
+	/*
+	 * QLSchedule Constructor
+	 * \param unit How time is counted
+	 */
+	QLSchedule(Unit unit) : _unit(unit) {};
+
+	virtual ~QLSchedule() {};
+
+	/*
+	 * Returns the value of the parameter at time n (the number of completed trials or steps)
+	 * \param n The time
+	 */
+	virtual double value(long n) const = 0;
+
+	/*
+	 * Returns how time is counted
+	 */
+	Unit getUnit() const {
+		return _unit;
+	};
+private:
+	Unit _unit;
+};
+
+/*
+ * ConstantSchedule Class
+ * The value never changes
+ */
+class ConstantSchedule : public QLSchedule {
+public:
+	/*
+	 * ConstantSchedule Constructor
+	 * \param value The value
+	 */
+	ConstantSchedule(double value) : QLSchedule(PerTrial), _value(value) {};
+
+	virtual ~ConstantSchedule() {};
+
+	virtual double value(long n) const {
+		return _value;
+	};
+private:
+	double _value;
+};
+
+/*
+ * LinearSchedule Class
+ * The value goes linearly from 'start' to 'end' in 'duration' trials or steps, then stays at 'end'
+ */
+class LinearSchedule : public QLSchedule {
+public:
+	/*
+	 * LinearSchedule Constructor
+	 * \param start The initial value
+	 * \param end The final value
+	 * \param duration The number of trials or steps to go from start to end
+	 * \param unit How time is counted
+	 */
+	LinearSchedule(double start, double end, long duration, Unit unit = PerTrial) : QLSchedule(unit), _start(start), _end(end), _duration(duration) {};
+
+	virtual ~LinearSchedule() {};
+
+	virtual double value(long n) const {
+		if(n >= _duration) return _end;
+		return _start + (_end - _start) * (static_cast<double>(n) / _duration);
+	};
+private:
+	double _start;
+	double _end;
+	long _duration;
+};
+
+/*
+ * ExponentialSchedule Class
+ * The value is multiplied by 'decay' every trial or step, and never goes below 'minimum'
+ *
+ * V = max(start * decay^n, minimum)
+ */
+class ExponentialSchedule : public QLSchedule {
+public:
+	/*
+	 * ExponentialSchedule Constructor
+	 * \param start The initial value
+	 * \param decay The decay factor, between 0 and 1
+	 * \param minimum The smallest value
+	 * \param unit How time is counted
+	 */
+	ExponentialSchedule(double start, double decay, double minimum = 0.0, Unit unit = PerTrial) : QLSchedule(unit), _start(start), _decay(decay), _minimum(minimum) {};
+
+	virtual ~ExponentialSchedule() {};
+
+	virtual double value(long n) const {
+		double v = _start * std::pow(_decay, static_cast<double>(n));
+		return (v > _minimum) ? v : _minimum;
+	};
+private:
+	double _start;
+	double _decay;
+	double _minimum;
+};
+
+/*
+ * InverseSchedule Class
+ * The value decays as 1/n
+ *
+ * V = start / (1 + decay * n)
+ */
+class InverseSchedule : public QLSchedule {
+public:
+	/*
+	 * InverseSchedule Constructor
+	 * \param start The initial value
+	 * \param decay How fast the value decays
+	 * \param unit How time is counted
+	 */
+	InverseSchedule(double start, double decay = 1.0, Unit unit = PerTrial) : QLSchedule(unit), _start(start), _decay(decay) {};
+
+	virtual ~InverseSchedule() {};
+
+	virtual double value(long n) const {
+		return _start / (1.0 + _decay * n);
+	};
+private:
+	double _start;
+	double _decay;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLSCHEDULE_H_ */
@@ -0,0 +1,360 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLSharedTable.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLSHAREDTABLE_H_
+#define QLSHAREDTABLE_H_
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "QLUtils.h"
+
+namespace QLLib {
+
+/*
+ * QLSharedTable Class
+ * The QLSharedTable class is a Q-table in POSIX shared memory, so several processes on the same host can learn into
+ * the same Q-values (i.e. when the problem isn't thread-safe and each learner needs its own process), while other
+ * processes read them (i.e. to serve the greedy policy).
+ * The layout is fixed: a header followed by one row of actions per state, as doubles that are read and written atomically.
+ * Updates are applied with add(), an atomic compare-and-swap loop, so concurrent updates of the same value aren't lost.
+ * The table can't grow, so all states must be created in setupStates().
+ * Open the table before the problem is initialized, through the algorithm:
+ *
+ * 	BasicQLearningAlgorithm<EpsilonGreedyPolicy, QLSharedTable> *a = ...;
+ * 	a->getTable().open("/my-table");
+ *
+ * The first process to initialize the table creates it and sets the initial Q-values, the others attach to it.
+ * The shared memory outlives the processes until remove() is called.
+ * Visit counts (see QLAlgorithm::enableVisitCounts()) stay private to each process.
+ */
+class QLSharedTable {
+public:
+	// row() copies the values into the caller's scratch space, add() updates a value atomically
+	typedef double Value;
+	static const bool copiesRows = true;
+	static const bool atomicAdd = true;
+
+	/*
+	 * QLSharedTable Constructor
+	 */
+	QLSharedTable() {};
+
+	/*
+	 * QLSharedTable Constructor
+	 * \param name The name of the shared memory object (a '/' followed by up to 250 characters)
+	 */
+	QLSharedTable(const std::string &name) : _name(name) {};
+
+	virtual ~QLSharedTable() {
+		unmap();
+	};
+
+	QLSharedTable(const QLSharedTable&) = delete;
+	QLSharedTable& operator=(const QLSharedTable&) = delete;
+
+	/*
+	 * Sets the name of the shared memory object the table is created in or attached to by init()
+	 * \param name The name of the shared memory object (a '/' followed by up to 250 characters)
+	 */
+	void open(const std::string &name) {
+		unmap();
+		_name = name;
+	};
+
+	/*
+	 * Sets how long init() waits for the process that created the table to initialize it, before it gives up.
+	 * The wait only times out if that process died while it was creating the table
+	 * \param seconds The timeout in seconds (5 by default)
+	 */
+	void setAttachTimeout(double seconds) {
+		_attachTimeout = seconds;
+	};
+
+	/*
+	 * Creates the table, or attaches to it if another process created it
+	 * \param states The number of states
+	 * \param actions The number of actions
+	 * \param initialQ The default Q-value (only used by the process that creates the table)
+	 */
+	void init(size_t states, size_t actions, double initialQ) {
+		if(_name.empty()) {
+			throw std::logic_error("[ERROR] The shared table needs a name, call open() before the problem is initialized");
+		}
+		unmap();
+		size_t size = sizeof(Header) + states * actions * sizeof(Cell);
+		bool created = true;
+		int fd = shm_open(_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if((fd < 0) && (errno == EEXIST)) {
+			created = false;
+			fd = shm_open(_name.c_str(), O_RDWR, 0600);
+		}
+		if(fd < 0) throw std::runtime_error("[ERROR] Could not open the shared table \"" + _name + "\"");
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(_attachTimeout);
+		if(created) {
+			if(ftruncate(fd, size) != 0) {
+				close(fd);
+				shm_unlink(_name.c_str());
+				throw std::runtime_error("[ERROR] Could not size the shared table \"" + _name + "\"");
+			}
+		} else {
+			// wait until the creator has sized the object
+			struct stat st;
+			while(true) {
+				if(fstat(fd, &st) != 0) {
+					close(fd);
+					throw std::runtime_error("[ERROR] Could not read the size of the shared table \"" + _name + "\"");
+				}
+				if(static_cast<size_t>(st.st_size) >= sizeof(Header)) break;
+				if(std::chrono::steady_clock::now() > deadline) {
+					close(fd);
+					throw std::runtime_error(attachTimeoutError());
+				}
+				std::this_thread::yield();
+			}
+			size = st.st_size;
+		}
+		void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if(map == MAP_FAILED) throw std::runtime_error("[ERROR] Could not map the shared table \"" + _name + "\"");
+		_map = map;
+		_mapSize = size;
+		_header = static_cast<Header*>(map);
+		_values = reinterpret_cast<Cell*>(static_cast<char*>(map) + sizeof(Header));
+		if(created) {
+			std::memcpy(_header->magic, "QLSHARED", 8);
+			_header->states = states;
+			_header->actions = actions;
+			_header->initialQ = initialQ;
+			for(size_t i = 0; i < states * actions; i++) new(&_values[i]) Cell(encode(initialQ));
+			new(&_header->ready) std::atomic<uint32_t>(0);
+			_header->ready.store(1, std::memory_order_release);
+		} else {
+			// wait until the creator has set the initial values
+			while(_header->ready.load(std::memory_order_acquire) == 0) {
+				if(std::chrono::steady_clock::now() > deadline) {
+					unmap();
+					throw std::runtime_error(attachTimeoutError());
+				}
+				std::this_thread::yield();
+			}
+			if((std::memcmp(_header->magic, "QLSHARED", 8) != 0) || (_header->states != states) || (_header->actions != actions) ||
+					(_mapSize != sizeof(Header) + states * actions * sizeof(Cell))) {
+				unmap();
+				throw std::runtime_error("[ERROR] The shared table \"" + _name + "\" has a different layout");
+			}
+		}
+		_states = states;
+		_actions = actions;
+	};
+
+	/*
+	 * Copies the Q-values of all actions of a state
+	 * \param stateId The id of the state
+	 * \param scratch An array of getActionCount() doubles that receives the values
+	 */
+	double* row(int stateId, double *scratch) {
+		copyRow(stateId, scratch);
+		return scratch;
+	};
+
+	/*
+	 * Copies the Q-values of a state without changing the table
+	 * \param stateId The id of the state
+	 * \param Q Output: an array of getActionCount() doubles
+	 */
+	void copyRow(int stateId, double Q[]) const {
+		const Cell *q = getRow(stateId);
+		for(size_t i = 0; i < _actions; i++) Q[i] = decode(q[i].load(std::memory_order_relaxed));
+	};
+
+	/*
+	 * Returns the Q-value of a state-action combination
+	 */
+	double get(int stateId, int actionId) {
+		return decode(getRow(stateId)[actionId].load(std::memory_order_relaxed));
+	};
+
+	/*
+	 * Sets the Q-value of a state-action combination (overwriting concurrent updates)
+	 */
+	void set(int stateId, int actionId, double value) {
+		getRow(stateId)[actionId].store(encode(value), std::memory_order_relaxed);
+	};
+
+	/*
+	 * Adds to the Q-value of a state-action combination atomically
+	 * \param stateId The id of the state
+	 * \param actionId The id of the action
+	 * \param delta The change of the Q-value
+	 */
+	void add(int stateId, int actionId, double delta) {
+		Cell &cell = getRow(stateId)[actionId];
+		uint64_t expected = cell.load(std::memory_order_relaxed);
+		while(!cell.compare_exchange_weak(expected, encode(decode(expected) + delta), std::memory_order_relaxed)) {}
+	};
+
+	/*
+	 * Returns the largest Q-value of a state
+	 */
+	double max(int stateId) {
+		return get(stateId, argmax(stateId));
+	};
+
+	/*
+	 * Returns the index of the action with the largest Q-value of a state (the first one, if there are several)
+	 */
+	int argmax(int stateId) {
+		const Cell *q = getRow(stateId);
+		int best = 0;
+		double bestQ = decode(q[0].load(std::memory_order_relaxed));
+		for(size_t i = 1; i < _actions; i++) {
+			double v = decode(q[i].load(std::memory_order_relaxed));
+			if(bestQ < v) {
+				bestQ = v;
+				best = i;
+			}
+		}
+		return best;
+	};
+
+	/*
+	 * Returns the number of states
+	 */
+	size_t getStateCount() const {
+		return _states;
+	};
+
+	/*
+	 * Returns the number of actions (the length of each row)
+	 */
+	size_t getActionCount() const {
+		return _actions;
+	};
+
+	/*
+	 * Does nothing: the table has a fixed size, set by init()
+	 */
+	void reserve(size_t states) {};
+
+	/*
+	 * Returns the size of the shared memory object (mapped by every process attached to it, but allocated once)
+	 */
+	size_t getMemoryUsage() const {
+		return _mapSize;
+	};
+
+	/*
+	 * Returns the size of the shared memory object of a table, without creating it
+	 */
+	static size_t estimateMemory(size_t states, size_t actions) {
+		return sizeof(Header) + states * actions * sizeof(Cell);
+	};
+
+	/*
+	 * Deletes a shared table: processes that are attached to it keep using it, and the memory is freed when they detach
+	 * \param name The name of the shared memory object
+	 */
+	static void remove(const std::string &name) {
+		shm_unlink(name.c_str());
+	};
+private:
+	// Q-values are stored as the bits of a double, so they can be updated with a compare-and-swap
+	typedef std::atomic<uint64_t> Cell;
+	static_assert(sizeof(Cell) == sizeof(double), "The shared table needs lock-free 64-bit atomics");
+
+	// The header of the shared memory object, one cache line so the rows are aligned
+	struct Header {
+		char magic[8];
+		std::atomic<uint32_t> ready;
+		uint32_t reserved;
+		uint64_t states;
+		uint64_t actions;
+		double initialQ;
+		char padding[24];
+	};
+	static_assert(sizeof(Header) == 64, "The shared table's header must be 64 bytes");
+
+	static uint64_t encode(double value) {
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	};
+
+	static double decode(uint64_t bits) {
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	};
+
+	Cell* getRow(int stateId) const {
+		if((stateId < 0) || (static_cast<size_t>(stateId) >= _states)) {
+			throw std::out_of_range("[ERROR] The state isn't part of the shared table (it can't grow, create all states in setupStates())");
+		}
+		return &_values[static_cast<size_t>(stateId) * _actions];
+	};
+
+	std::string attachTimeoutError() const {
+		return "[ERROR] Timed out waiting for the shared table \"" + _name + "\" to be initialized: if the process that created it died, "
+				"delete it with QLSharedTable::remove(\"" + _name + "\") and try again";
+	};
+
+	void unmap() {
+		if(_map != nullptr) munmap(_map, _mapSize);
+		_map = nullptr;
+		_mapSize = 0;
+		_header = nullptr;
+		_values = nullptr;
+		_states = 0;
+		_actions = 0;
+	};
+
+	std::string _name;
+	double _attachTimeout = 5.0;
+	void *_map = nullptr;
+	size_t _mapSize = 0;
+	Header *_header = nullptr;
+	Cell *_values = nullptr;
+	size_t _states = 0;
+	size_t _actions = 0;
+};
+
+namespace Utils {
+
+// Shared tables have atomic cells and can't grow
+template<>
+struct ConcurrentReads<QLLib::QLSharedTable> : std::true_type {};
+
+} /* namespace Utils */
+
+} /* namespace QLLib */
+
+#endif /* QLSHAREDTABLE_H_ */
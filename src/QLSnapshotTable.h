@@ -0,0 +1,461 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLSnapshotTable.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLSNAPSHOTTABLE_H_
+#define QLSNAPSHOTTABLE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "QLUtils.h"
+
+namespace QLLib {
+namespace Utils {
+
+/*
+ * TableFileHeader Struct
+ * The header of the files Q-tables are saved to
+ */
+struct TableFileHeader {
+	char magic[8];
+	uint32_t version = 1;
+	// The size of a Q-value (i.e. 8 for doubles)
+	uint32_t valueBytes = 0;
+	uint64_t states = 0;
+	uint64_t actions = 0;
+	// Incremented by each compaction of an incremental checkpoint (see QLCheckpoint.h)
+	uint64_t generation = 0;
+
+	TableFileHeader() {
+		std::memcpy(magic, "QLTABLE", 8);
+	};
+
+	TableFileHeader(size_t s, size_t a, size_t bytes) : valueBytes(bytes), states(s), actions(a) {
+		std::memcpy(magic, "QLTABLE", 8);
+	};
+
+	bool valid() const {
+		return (std::memcmp(magic, "QLTABLE", 8) == 0) && (version == 1);
+	};
+};
+
+} /* namespace Utils */
+
+template<class T> class BasicQLSnapshotTable;
+
+/*
+ * QLTableSnapshot Class
+ * An immutable view of a BasicQLSnapshotTable at the time snapshot() was called.
+ * The snapshot shares the table's pages until the table writes to them, so taking it is cheap,
+ * and it can be read (i.e. evaluated with QL::evaluate() or saved) on any thread while the table keeps learning.
+ */
+template<class T>
+class QLTableSnapshot {
+	friend class BasicQLSnapshotTable<T>;
+public:
+	/*
+	 * QLTableSnapshot Constructor
+	 * Creates an empty snapshot
+	 */
+	QLTableSnapshot() {};
+
+	virtual ~QLTableSnapshot() {};
+
+	/*
+	 * Returns the Q-values of all actions of a state
+	 * \param stateId The id of the state
+	 */
+	const T* getRow(int stateId) const {
+		if((stateId < 0) || (static_cast<size_t>(stateId) >= _states)) {
+			throw std::out_of_range("[ERROR] The state isn't part of the snapshot");
+		}
+		return &(*_pages[stateId >> _pageShift])[(stateId & _pageMask) * _actions];
+	};
+
+	/*
+	 * Copies the Q-values of a state as doubles
+	 * \param stateId The id of the state
+	 * \param Q Output: an array of getActionCount() doubles
+	 */
+	void copyRow(int stateId, double Q[]) const {
+		const T *q = getRow(stateId);
+		for(size_t i = 0; i < _actions; i++) Q[i] = q[i];
+	};
+
+	/*
+	 * Returns the Q-value of a state-action combination
+	 */
+	double get(int stateId, int actionId) const {
+		return getRow(stateId)[actionId];
+	};
+
+	/*
+	 * Returns the index of the action with the largest Q-value of a state (the first one, if there are several)
+	 */
+	int argmax(int stateId) const {
+		return QLLib::Utils::indexOfLargest(getRow(stateId), _actions);
+	};
+
+	/*
+	 * Returns the number of states
+	 */
+	size_t getStateCount() const {
+		return _states;
+	};
+
+	/*
+	 * Returns the number of actions (the length of each row)
+	 */
+	size_t getActionCount() const {
+		return _actions;
+	};
+
+	/*
+	 * Returns true if the snapshot knows which rows changed since the previous one (see BasicQLSnapshotTable::snapshot())
+	 */
+	bool hasDirtyRows() const {
+		return _tracksDirtyRows;
+	};
+
+	/*
+	 * Returns true if the row of a state changed since the previous snapshot that took the dirty rows
+	 * \param stateId The id of the state
+	 */
+	bool isDirty(int stateId) const {
+		size_t word = static_cast<size_t>(stateId) >> 6;
+		return (word < _dirty.size()) && ((_dirty[word] >> (stateId & 63)) & 1);
+	};
+
+	/*
+	 * Returns the ids of the states whose row changed since the previous snapshot that took the dirty rows
+	 */
+	std::vector<int> getDirtyRows() const {
+		std::vector<int> rows;
+		for(size_t w = 0; w < _dirty.size(); w++) {
+			for(uint64_t bits = _dirty[w]; bits != 0; bits &= bits - 1) {
+				rows.push_back(static_cast<int>((w << 6) + lowestBit(bits)));
+			}
+		}
+		return rows;
+	};
+
+	/*
+	 * Saves the Q-values to a file, which BasicQLSnapshotTable::load() can restore
+	 * The file has a header followed by the rows of all states
+	 * \param path The file name
+	 * \param generation The generation written in the header (see QLCheckpoint.h)
+	 */
+	void save(const std::string &path, uint64_t generation = 0) const {
+		std::ofstream out(path.c_str(), std::ios::binary);
+		if(!out) throw std::runtime_error("[ERROR] Could not open \"" + path + "\" for writing");
+		QLLib::Utils::TableFileHeader h(_states, _actions, sizeof(T));
+		h.generation = generation;
+		out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+		for(size_t s = 0; s < _states; s += _pageMask + 1) {
+			size_t rows = std::min(static_cast<size_t>(_pageMask + 1), _states - s);
+			out.write(reinterpret_cast<const char*>(getRow(s)), rows * _actions * sizeof(T));
+		}
+		if(!out) throw std::runtime_error("[ERROR] Could not write \"" + path + "\"");
+	};
+private:
+	/*
+	 * Returns the index of the lowest set bit of a non-zero word (a de Bruijn bit scan, so it doesn't need compiler intrinsics)
+	 */
+	static int lowestBit(uint64_t bits) {
+		static const int index[64] = {
+			0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+			62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+			63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+			46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+		};
+		return index[((bits & (~bits + 1)) * UINT64_C(0x03f79d71b4cb0a89)) >> 58];
+	};
+
+	std::vector<std::shared_ptr<const std::vector<T>>> _pages;
+	// one bit per state, set for the rows that changed since the previous snapshot that took them
+	std::vector<uint64_t> _dirty;
+	bool _tracksDirtyRows = false;
+	size_t _states = 0;
+	size_t _actions = 0;
+	int _pageShift = 0;
+	int _pageMask = 0;
+};
+
+/*
+ * BasicQLSnapshotTable Class
+ * The BasicQLSnapshotTable class is a Q-table that can take snapshots while it learns.
+ * Q-values are stored like in BasicQLLookupTable (one row of actions per state, of type T), but in pages of rows
+ * that are shared with the snapshots: a page is copied the first time the table writes to it after a snapshot
+ * (copy-on-write), so a snapshot only costs a pointer per page, and the pages that don't change are never copied.
+ * The table also keeps a bitmap of the rows changed by set(), so checkpoints can save only the changed rows (see QLCheckpoint.h).
+ * snapshot() must be called on the thread that trains (i.e. from an event listener or a command posted to QL),
+ * the snapshot can then be handed to any thread:
+ *
+ * 	ql->addEventListener([&](const QLLib::Utils::Stats &stats) {
+ * 		if(stats.trialsCompleted % 100 == 0) checkpointer.push(algorithm->getTable().snapshot());
+ * 	});
+ */
+template<class T>
+class BasicQLSnapshotTable {
+public:
+	typedef T Value;
+	typedef QLTableSnapshot<T> Snapshot;
+	// row() returns the table's own storage
+	static const bool copiesRows = false;
+	static const bool atomicAdd = false;
+
+	/*
+	 * BasicQLSnapshotTable Constructor
+	 * \param pageBytes The approximate size of a page (the number of rows per page is rounded down to a power of 2)
+	 */
+	BasicQLSnapshotTable(size_t pageBytes = 65536) : _pageBytes(pageBytes) {};
+
+	virtual ~BasicQLSnapshotTable() {};
+
+	/*
+	 * Initializes the table, setting the default value for all state-action combinations
+	 * \param states The number of states known in advance
+	 * \param actions The number of actions
+	 * \param initialQ The default Q-value
+	 */
+	void init(size_t states, size_t actions, double initialQ) {
+		_actions = actions;
+		_initialQ = static_cast<T>(initialQ);
+		_pageShift = pageShift(actions, _pageBytes);
+		_pageMask = (1 << _pageShift) - 1;
+		_pages.clear();
+		_dirty.clear();
+		_states = 0;
+		if(states > 0) grow(states - 1);
+	};
+
+	/*
+	 * Returns the Q-values of all actions of a state, for reading
+	 * The pointer is valid until the next change of the table
+	 * \param stateId The id of the state
+	 */
+	const T* getRow(int stateId) {
+		if(static_cast<size_t>(stateId) >= _states) grow(stateId);
+		return &(*_pages[stateId >> _pageShift])[(stateId & _pageMask) * _actions];
+	};
+
+	/*
+	 * Returns the Q-values of all actions of a state (the interface shared by all Q-tables, see QLCompactTable.h)
+	 * \param stateId The id of the state
+	 * \param scratch Unused: the row is returned in place
+	 * The algorithms only read the row: writing to it would bypass copy-on-write, use set()
+	 */
+	T* row(int stateId, double *scratch) {
+		return const_cast<T*>(getRow(stateId));
+	};
+
+	/*
+	 * Copies the Q-values of a state without changing the table: states that don't have a row yet get the initial value.
+	 * Several threads can call it at the same time, as long as no thread changes the table: read a snapshot() instead while it learns
+	 * \param stateId The id of the state
+	 * \param Q Output: an array of getActionCount() doubles
+	 */
+	void copyRow(int stateId, double Q[]) const {
+		if(stateId < 0) {
+			throw std::out_of_range("[ERROR] The state isn't part of the problem");
+		}
+		if(static_cast<size_t>(stateId) >= _states) {
+			for(size_t i = 0; i < _actions; i++) Q[i] = _initialQ;
+			return;
+		}
+		const T *q = &(*_pages[stateId >> _pageShift])[(stateId & _pageMask) * _actions];
+		for(size_t i = 0; i < _actions; i++) Q[i] = q[i];
+	};
+
+	/*
+	 * Returns the Q-value of a state-action combination
+	 */
+	double get(int stateId, int actionId) {
+		return getRow(stateId)[actionId];
+	};
+
+	/*
+	 * Sets the Q-value of a state-action combination, copying its page first if a snapshot shares it
+	 */
+	void set(int stateId, int actionId, double value) {
+		if(static_cast<size_t>(stateId) >= _states) grow(stateId);
+		std::shared_ptr<std::vector<T>> &page = _pages[stateId >> _pageShift];
+		if(page.use_count() != 1) {
+			page = std::make_shared<std::vector<T>>(*page);
+		} else {
+			// use_count() is a relaxed load: the fence orders the write after the reads of the snapshot that just released the page
+			std::atomic_thread_fence(std::memory_order_acquire);
+		}
+		(*page)[(stateId & _pageMask) * _actions + actionId] = static_cast<T>(value);
+		_dirty[stateId >> 6] |= static_cast<uint64_t>(1) << (stateId & 63);
+	};
+
+	/*
+	 * Returns the largest Q-value of a state
+	 */
+	double max(int stateId) {
+		return getRow(stateId)[argmax(stateId)];
+	};
+
+	/*
+	 * Returns the index of the action with the largest Q-value of a state (the first one, if there are several)
+	 */
+	int argmax(int stateId) {
+		return QLLib::Utils::indexOfLargest(getRow(stateId), _actions);
+	};
+
+	/*
+	 * Returns a snapshot of the table. Call it on the thread that trains
+	 * \param takeDirtyRows True to give the snapshot the bitmap of the rows changed since the previous snapshot
+	 * that took it, and to clear the table's bitmap
+	 */
+	Snapshot snapshot(bool takeDirtyRows = false) {
+		Snapshot s;
+		s._pages.assign(_pages.begin(), _pages.end());
+		if(takeDirtyRows) {
+			s._dirty.assign(_dirty.size(), 0);
+			s._dirty.swap(_dirty);
+			s._tracksDirtyRows = true;
+		}
+		s._states = _states;
+		s._actions = _actions;
+		s._pageShift = _pageShift;
+		s._pageMask = _pageMask;
+		return s;
+	};
+
+	/*
+	 * Restores the Q-values saved with QLTableSnapshot::save(). Call it after the table is initialized
+	 * \param path The file name
+	 */
+	void load(const std::string &path) {
+		std::ifstream in(path.c_str(), std::ios::binary);
+		if(!in) throw std::runtime_error("[ERROR] Could not open \"" + path + "\"");
+		QLLib::Utils::TableFileHeader h;
+		in.read(reinterpret_cast<char*>(&h), sizeof(h));
+		if(!in || !h.valid() || (h.actions != _actions) || (h.valueBytes != sizeof(T))) {
+			throw std::runtime_error("[ERROR] \"" + path + "\" isn't a checkpoint of this table");
+		}
+		if(h.states > _states) grow(h.states - 1);
+		std::vector<T> row(_actions);
+		for(size_t s = 0; s < h.states; s++) {
+			if(!in.read(reinterpret_cast<char*>(row.data()), _actions * sizeof(T))) {
+				throw std::runtime_error("[ERROR] \"" + path + "\" is truncated");
+			}
+			for(size_t a = 0; a < _actions; a++) set(s, a, row[a]);
+		}
+	};
+
+	/*
+	 * Returns the number of states that have a row in the table
+	 */
+	size_t getStateCount() const {
+		return _states;
+	};
+
+	/*
+	 * Returns the number of actions (the length of each row)
+	 */
+	size_t getActionCount() const {
+		return _actions;
+	};
+
+	/*
+	 * Allocates the page list and the bitmap for 'states' states (pages are allocated when they are first used)
+	 * \param states The number of states expected
+	 */
+	void reserve(size_t states) {
+		_pages.reserve((states >> _pageShift) + 1);
+		_dirty.reserve((states + 63) >> 6);
+	};
+
+	/*
+	 * Returns the number of bytes allocated for the pages, including the pages shared with snapshots
+	 */
+	size_t getMemoryUsage() const {
+		size_t bytes = _pages.capacity() * sizeof(std::shared_ptr<std::vector<T>>) + _dirty.capacity() * sizeof(uint64_t);
+		for(auto &page : _pages) bytes += kPageOverhead + page->capacity() * sizeof(T);
+		return bytes;
+	};
+
+	/*
+	 * Returns the number of bytes a table of this type would take, without allocating it (and without snapshots)
+	 * \param states The number of states
+	 * \param actions The number of actions
+	 * \param pageBytes The size of a page, as passed to the constructor
+	 */
+	static size_t estimateMemory(size_t states, size_t actions, size_t pageBytes = 65536) {
+		size_t rows = static_cast<size_t>(1) << pageShift(actions, pageBytes);
+		size_t pages = (states + rows - 1) / rows;
+		return pages * (sizeof(std::shared_ptr<std::vector<T>>) + kPageOverhead + rows * actions * sizeof(T)) + ((states + 63) >> 6) * sizeof(uint64_t);
+	};
+private:
+	// the vector and the shared_ptr's control block of a page, allocated together by make_shared
+	static const size_t kPageOverhead = sizeof(std::vector<T>) + sizeof(void*) + 2 * sizeof(int);
+
+	/*
+	 * Returns the log2 of the number of rows per page: the largest power of 2 rows that fit in pageBytes
+	 */
+	static int pageShift(size_t actions, size_t pageBytes) {
+		size_t rows = pageBytes / (std::max(static_cast<size_t>(1), actions) * sizeof(T));
+		int shift = 0;
+		while((static_cast<size_t>(2) << shift) <= rows) shift++;
+		return shift;
+	};
+
+	void grow(int stateId) {
+		if(stateId < 0) {
+			throw std::out_of_range("[ERROR] The state isn't part of the problem");
+		}
+		_states = static_cast<size_t>(stateId) + 1;
+		size_t pages = (_states >> _pageShift) + (((_states & _pageMask) != 0) ? 1 : 0);
+		while(_pages.size() < pages) {
+			_pages.push_back(std::make_shared<std::vector<T>>((_pageMask + 1) * _actions, _initialQ));
+		}
+		_dirty.resize((_states + 63) >> 6, 0);
+	};
+
+	std::vector<std::shared_ptr<std::vector<T>>> _pages;
+	// one bit per state, set by set() and cleared by snapshot(true)
+	std::vector<uint64_t> _dirty;
+	size_t _pageBytes;
+	size_t _states = 0;
+	size_t _actions = 0;
+	int _pageShift = 0;
+	int _pageMask = 0;
+	T _initialQ = T();
+};
+
+// Snapshot table of doubles
+typedef BasicQLSnapshotTable<double> QLSnapshotTable;
+
+// Snapshot table of floats
+typedef BasicQLSnapshotTable<float> QLFloatSnapshotTable;
+
+} /* namespace QLLib */
+
+#endif /* QLSNAPSHOTTABLE_H_ */
@@ -1,54 +1,168 @@
-/*
- * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *     http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- *
- * QLState.h
- *
- *  Created on: Dec 15, 2015
- *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
- */
-
-#ifndef QLSTATE_H_
-#define QLSTATE_H_
-
-namespace QLLib {
-
-/*
- * QLState Class
- * The QLState class represents a 'state' that the agent can be in.
- * You can inherit from this class and structure it however you like
- */
-class QLState {
-public:
-	/*
-	 * QLState Constructor
-	 * \param stateName The name that uniquely identifies the state
-	 */
-	QLState(std::string stateName) : _name(stateName) {};
-
-	virtual ~QLState() {};
-
-	/*
-	 * Returns the state's printable name
-	 */
-	std::string getName() const {
-		return _name;
-	};
-private:
-	std::string _name;
-};
-
-} /* namespace QLLib */
-
-#endif /* QLSTATE_H_ */
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLState.h
+ *
+ *  Created on: Dec 15, 2015
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLSTATE_H_
+#define QLSTATE_H_
+
+#include <string>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+
+#ifndef QLLIB_MAX_KEY_DIMENSIONS
+#define QLLIB_MAX_KEY_DIMENSIONS 4
+#endif
+
+namespace QLLib {
+
+/*
+ * QLStateKey Class
+ * A small tuple of integers (i.e. the x,y coordinates of a cell) that identifies a state
+ * without building a string. At most QLLIB_MAX_KEY_DIMENSIONS values are stored, inline.
+ */
+class QLStateKey {
+public:
+	/*
+	 * QLStateKey Constructor - creates an empty key
+	 */
+	QLStateKey() : _size(0) {};
+
+	/*
+	 * QLStateKey Constructor
+	 * \param values The values of the key, i.e. {x, y}
+	 */
+	QLStateKey(std::initializer_list<int> values) : _size(0) {
+		for(auto i : values) push_back(i);
+	};
+
+	/*
+	 * Returns the number of values in the key
+	 */
+	int size() const {
+		return _size;
+	};
+
+	bool empty() const {
+		return _size == 0;
+	};
+
+	/*
+	 * Appends a value to the key
+	 * Throws std::length_error if the key already has QLLIB_MAX_KEY_DIMENSIONS values (define it before including QLLib to raise it)
+	 */
+	void push_back(int value) {
+		if(_size >= QLLIB_MAX_KEY_DIMENSIONS) {
+			throw std::length_error("[ERROR] A state key can't have more than QLLIB_MAX_KEY_DIMENSIONS values");
+		}
+		_values[_size++] = value;
+	};
+
+	int operator[](int i) const {
+		return _values[i];
+	};
+
+	int& operator[](int i) {
+		return _values[i];
+	};
+
+	bool operator==(const QLStateKey &key) const {
+		if(_size != key._size) return false;
+		for(int i = 0; i < _size; i++) {
+			if(_values[i] != key._values[i]) return false;
+		}
+		return true;
+	};
+
+	bool operator!=(const QLStateKey &key) const {
+		return !(*this == key);
+	};
+private:
+	int _size;
+	int _values[QLLIB_MAX_KEY_DIMENSIONS];
+};
+
+/*
+ * QLStateKeyHash Class
+ * This class creates a hash based on the key's values
+ */
+class QLStateKeyHash {
+public:
+	size_t operator()(const QLStateKey &key) const {
+		size_t h = key.size();
+		for(int i = 0; i < key.size(); i++) {
+			h ^= std::hash<int>()(key[i]) + 0x9e3779b9 + (h << 6) + (h >> 2);
+		}
+		return h;
+	};
+};
+
+/*
+ * QLState Class
+ * The QLState class represents a 'state' that the agent can be in.
+ * You can inherit from this class and structure it however you like
+ */
+class QLState {
+	friend class QLProblem;
+public:
+	/*
+	 * QLState Constructor
+	 * \param stateName The name that uniquely identifies the state
+	 */
+	QLState(std::string stateName) : _name(stateName) {};
+
+	/*
+	 * QLState Constructor
+	 * \param stateName The name that uniquely identifies the state
+	 * \param key The tuple of integers that uniquely identifies the state, i.e. {x, y}
+	 */
+	QLState(std::string stateName, QLLib::QLStateKey key) : _name(stateName), _key(key) {};
+
+	virtual ~QLState() {};
+
+	/*
+	 * Returns the state's printable name
+	 */
+	const std::string& getName() const {
+		return _name;
+	};
+
+	/*
+	 * Returns the state's key (empty if the state doesn't have one)
+	 */
+	const QLLib::QLStateKey& getKey() const {
+		return _key;
+	};
+
+	/*
+	 * Returns the state's index in the problem (the order in which it was added), or -1 if it wasn't added to a problem
+	 */
+	int getId() const {
+		return _id;
+	};
+private:
+	std::string _name;
+	QLLib::QLStateKey _key;
+	int _id = -1;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLSTATE_H_ */
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLStateSpace.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLSTATESPACE_H_
+#define QLSTATESPACE_H_
+
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include "QLState.h"
+
+namespace QLLib {
+
+/*
+ * QLStateSpace Class
+ * The QLStateSpace class describes a space of states identified by QLStateKeys,
+ * where every value of the key has a declared range (i.e. x in [1,10] and y in [1,10]).
+ * Each key in the space maps to a unique, dense index using mixed-radix encoding,
+ * so keys can be turned into indices (and back) and neighbours can be reached with integer arithmetic only.
+ */
+class QLStateSpace {
+public:
+	static const size_t npos = static_cast<size_t>(-1);
+
+	/*
+	 * QLStateSpace Constructor - creates an empty space
+	 */
+	QLStateSpace() {};
+
+	/*
+	 * QLStateSpace Constructor
+	 * \param ranges The inclusive {min, max} range of each value of the key, i.e. {{1, 10}, {1, 10}}
+	 */
+	QLStateSpace(std::initializer_list<std::pair<int, int>> ranges) {
+		for(auto i : ranges) addDimension(i.first, i.second);
+	};
+
+	virtual ~QLStateSpace() {};
+
+	/*
+	 * Adds a dimension to the space
+	 * \param min The smallest value of the dimension
+	 * \param max The largest value of the dimension
+	 * Throws std::length_error if the space already has QLLIB_MAX_KEY_DIMENSIONS dimensions
+	 */
+	QLStateSpace& addDimension(int min, int max) {
+		if(_dimensions >= QLLIB_MAX_KEY_DIMENSIONS) {
+			throw std::length_error("[ERROR] A state space can't have more than QLLIB_MAX_KEY_DIMENSIONS dimensions");
+		}
+		_min[_dimensions] = min;
+		_radix[_dimensions] = (max >= min) ? (max - min + 1) : 0;
+		_dimensions++;
+		computeStrides();
+		return *this;
+	};
+
+	/*
+	 * Returns the number of dimensions
+	 */
+	int dimensions() const {
+		return _dimensions;
+	};
+
+	/*
+	 * Returns the number of states in the space
+	 */
+	size_t size() const {
+		return _size;
+	};
+
+	/*
+	 * Returns true if the space has no states
+	 */
+	bool empty() const {
+		return _size == 0;
+	};
+
+	/*
+	 * Checks if a key lies within the space
+	 */
+	bool contains(const QLLib::QLStateKey &key) const {
+		if(key.size() != _dimensions) return false;
+		for(int i = 0; i < _dimensions; i++) {
+			if(static_cast<unsigned>(key[i] - _min[i]) >= _radix[i]) return false;
+		}
+		return true;
+	};
+
+	/*
+	 * Returns the index of a key, or npos if the key is outside the space
+	 */
+	size_t encode(const QLLib::QLStateKey &key) const {
+		if(!contains(key)) return npos;
+		size_t index = 0;
+		for(int i = 0; i < _dimensions; i++) {
+			index += static_cast<size_t>(key[i] - _min[i]) * _stride[i];
+		}
+		return index;
+	};
+
+	/*
+	 * Returns the key of an index
+	 */
+	QLLib::QLStateKey decode(size_t index) const {
+		QLLib::QLStateKey key;
+		for(int i = 0; i < _dimensions; i++) {
+			key.push_back(coordinate(index, i));
+		}
+		return key;
+	};
+
+	/*
+	 * Returns the value of one dimension of an index (i.e. the 'x' of the state)
+	 * \param index The index of a state
+	 * \param dimension The dimension
+	 */
+	int coordinate(size_t index, int dimension) const {
+		return _min[dimension] + static_cast<int>((index / _stride[dimension]) % _radix[dimension]);
+	};
+
+	/*
+	 * Returns the distance between the indices of two keys that differ by 1 in the given dimension
+	 */
+	size_t stride(int dimension) const {
+		return _stride[dimension];
+	};
+
+	/*
+	 * Returns the index reached by moving 'delta' steps along a dimension, or npos if it falls outside the space
+	 * i.e. neighbour(index, 0, +1) is the index of (x+1, y)
+	 * \param index The index of a state
+	 * \param dimension The dimension to move along
+	 * \param delta The number of steps
+	 */
+	size_t neighbour(size_t index, int dimension, int delta) const {
+		int value = coordinate(index, dimension) - _min[dimension] + delta;
+		if(static_cast<unsigned>(value) >= _radix[dimension]) return npos;
+		if(delta >= 0) return index + static_cast<size_t>(delta) * _stride[dimension];
+		else return index - static_cast<size_t>(-delta) * _stride[dimension];
+	};
+private:
+	void computeStrides() {
+		// the last dimension varies fastest, like a C array
+		_size = (_dimensions > 0) ? 1 : 0;
+		for(int i = _dimensions - 1; i >= 0; i--) {
+			_stride[i] = _size;
+			_size *= _radix[i];
+		}
+	};
+
+	int _dimensions = 0;
+	int _min[QLLIB_MAX_KEY_DIMENSIONS];
+	unsigned _radix[QLLIB_MAX_KEY_DIMENSIONS];
+	size_t _stride[QLLIB_MAX_KEY_DIMENSIONS];
+	size_t _size = 0;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLSTATESPACE_H_ */
@@ -0,0 +1,326 @@
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLSweep.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLSWEEP_H_
+#define QLSWEEP_H_
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include "QL.h"
+
+namespace QLLib {
+namespace Utils {
+
+/*
+ * SweepConfig Struct
+ * The parameters of one run of a sweep. The problem factory builds the run's algorithm and policy with them
+ */
+struct SweepConfig {
+	double alpha = 0.5;
+	double gamma = 0.9;
+	double epsilon = 0.1;
+	double initialQ = 0.0;
+	// The seed of the run's random number engine (see seedRandom()), so the run can be repeated alone
+	unsigned seed = 0;
+};
+
+/*
+ * SweepRange Struct
+ * The range a parameter is sampled from by QLSweep::addRandom()
+ */
+struct SweepRange {
+	double min;
+	double max;
+};
+
+/*
+ * SweepResult Struct
+ * The result of a configuration of a sweep, averaged over its repeats
+ */
+struct SweepResult {
+	SweepConfig config;
+	// The mean return of the greedy evaluation episodes after training, and its standard deviation across repeats
+	double score = 0.0;
+	double scoreStd = 0.0;
+	// The mean length of the evaluation episodes
+	double evaluationSteps = 0.0;
+	// The mean return of the last 10% of the training trials
+	double trainingReward = 0.0;
+	// The time taken by all repeats
+	double seconds = 0.0;
+};
+
+} /* namespace Utils */
+
+/*
+ * QLSweep Class - Runs a hyperparameter sweep
+ * Every configuration (from a grid or sampled at random) is trained for a number of trials, then evaluated greedily.
+ * Runs are independent and are scheduled on a pool of threads, each run with its own problem and a seed derived
+ * from the sweep's seed and the run's index, so a sweep gives the same results whatever the number of threads
+ * (provided the problem only uses the library's random functions). The results are ranked by score, then by training reward.
+ */
+class QLSweep {
+public:
+	typedef std::function<QLLib::QLProblem*(const QLLib::Utils::SweepConfig&)> ProblemFactory;
+
+	/*
+	 * QLSweep Constructor
+	 * \param createProblem Creates the problem of a run. The problem's setupAlgorithm() must use the config's parameters
+	 */
+	QLSweep(ProblemFactory createProblem) : _createProblem(createProblem) {};
+
+	virtual ~QLSweep() {};
+
+	/*
+	 * Adds all combinations of the provided values
+	 */
+	void addGrid(const std::vector<double> &alphas, const std::vector<double> &gammas, const std::vector<double> &epsilons, const std::vector<double> &initialQs) {
+		for(double alpha : alphas) {
+			for(double gamma : gammas) {
+				for(double epsilon : epsilons) {
+					for(double initialQ : initialQs) {
+						QLLib::Utils::SweepConfig c;
+						c.alpha = alpha;
+						c.gamma = gamma;
+						c.epsilon = epsilon;
+						c.initialQ = initialQ;
+						_configs.push_back(c);
+					}
+				}
+			}
+		}
+	};
+
+	/*
+	 * Adds 'n' configurations sampled uniformly from the provided ranges
+	 * The samples only depend on the sweep's seed
+	 */
+	void addRandom(int n, QLLib::Utils::SweepRange alpha, QLLib::Utils::SweepRange gamma, QLLib::Utils::SweepRange epsilon, QLLib::Utils::SweepRange initialQ) {
+		std::mt19937 engine(_seed + _configs.size());
+		std::uniform_real_distribution<double> u(0.0, 1.0);
+		for(int i = 0; i < n; i++) {
+			QLLib::Utils::SweepConfig c;
+			c.alpha = alpha.min + u(engine) * (alpha.max - alpha.min);
+			c.gamma = gamma.min + u(engine) * (gamma.max - gamma.min);
+			c.epsilon = epsilon.min + u(engine) * (epsilon.max - epsilon.min);
+			c.initialQ = initialQ.min + u(engine) * (initialQ.max - initialQ.min);
+			_configs.push_back(c);
+		}
+	};
+
+	/*
+	 * Adds a single configuration
+	 */
+	void addConfig(const QLLib::Utils::SweepConfig &config) {
+		_configs.push_back(config);
+	};
+
+	/*
+	 * Sets the number of training trials of each run
+	 */
+	void setTrials(int trials) {
+		_trials = trials;
+	};
+
+	/*
+	 * Limits the training of each run (see QL::setBudget()), i.e. so configurations whose early trials never end
+	 * don't stall the sweep. A time limit makes the results depend on the machine's speed
+	 */
+	void setBudget(const QLLib::Utils::Budget &budget) {
+		_budget = budget;
+	};
+
+	/*
+	 * Sets the number of greedy evaluation episodes after training, and the step limit of each episode
+	 */
+	void setEvaluation(int episodes, int maxSteps) {
+		_evaluationEpisodes = episodes;
+		_maxSteps = maxSteps;
+	};
+
+	/*
+	 * Sets how many times each configuration is run, with different seeds
+	 */
+	void setRepeats(int repeats) {
+		_repeats = std::max(1, repeats);
+	};
+
+	/*
+	 * Sets the number of threads (0 uses all the machine's cores)
+	 */
+	void setThreads(int threads) {
+		_threads = threads;
+	};
+
+	/*
+	 * Sets the seed all runs' seeds are derived from
+	 */
+	void setSeed(unsigned seed) {
+		_seed = seed;
+	};
+
+	/*
+	 * Runs the sweep and returns the results ranked by score, then by training reward (best first)
+	 * If a run throws, no new runs are started and the exception is rethrown once the running ones have finished
+	 */
+	std::vector<QLLib::Utils::SweepResult> run() {
+		int runs = _configs.size() * _repeats;
+		std::vector<Run> results(runs);
+		int threads = (_threads > 0) ? _threads : std::max(1u, std::thread::hardware_concurrency());
+		threads = std::max(1, std::min(threads, runs));
+		std::atomic<int> next{0};
+		std::vector<std::thread> pool;
+		for(int i = 0; i < threads; i++) {
+			pool.push_back(std::thread([this, &next, &results, runs]() {
+				for(int r = next.fetch_add(1); r < runs; r = next.fetch_add(1)) {
+					try {
+						runOne(r, results[r]);
+					} catch(...) {
+						results[r].error = std::current_exception();
+						next.store(runs);
+					}
+				}
+			}));
+		}
+		for(auto &t : pool) t.join();
+		for(auto &r : results) {
+			if(r.error) std::rethrow_exception(r.error);
+		}
+		// Average the repeats of each configuration
+		_results.clear();
+		for(size_t c = 0; c < _configs.size(); c++) {
+			QLLib::Utils::SweepResult result;
+			result.config = _configs[c];
+			result.config.seed = runSeed(c * _repeats);
+			double sumSquares = 0.0;
+			for(int k = 0; k < _repeats; k++) {
+				const Run &r = results[c * _repeats + k];
+				result.score += r.score / _repeats;
+				sumSquares += r.score * r.score / _repeats;
+				result.evaluationSteps += r.evaluationSteps / _repeats;
+				result.trainingReward += r.trainingReward / _repeats;
+				result.seconds += r.seconds;
+			}
+			result.scoreStd = std::sqrt(std::max(0.0, sumSquares - result.score * result.score));
+			_results.push_back(result);
+		}
+		std::stable_sort(_results.begin(), _results.end(), [](const QLLib::Utils::SweepResult &a, const QLLib::Utils::SweepResult &b) {
+			return (a.score > b.score) || ((a.score == b.score) && (a.trainingReward > b.trainingReward));
+		});
+		return _results;
+	};
+
+	/*
+	 * Prints the ranked results of the last run() as a table
+	 * \param out The stream
+	 * \param top The number of rows (0 prints all)
+	 */
+	void printSummary(std::ostream &out = std::cout, int top = 0) const {
+		int rows = ((top > 0) && (top < static_cast<int>(_results.size()))) ? top : _results.size();
+		std::streamsize precision = out.precision();
+		out << std::setw(5) << "rank" << std::setw(9) << "alpha" << std::setw(9) << "gamma" << std::setw(9) << "epsilon";
+		out << std::setw(10) << "initialQ" << std::setw(12) << "score" << std::setw(10) << "std" << std::setw(10) << "steps";
+		out << std::setw(12) << "training" << std::setw(12) << "seed" << std::endl;
+		for(int i = 0; i < rows; i++) {
+			const QLLib::Utils::SweepResult &r = _results[i];
+			out << std::setw(5) << (i + 1) << std::fixed << std::setprecision(3);
+			out << std::setw(9) << r.config.alpha << std::setw(9) << r.config.gamma << std::setw(9) << r.config.epsilon;
+			out << std::setw(10) << r.config.initialQ << std::setprecision(2) << std::setw(12) << r.score << std::setw(10) << r.scoreStd;
+			out << std::setw(10) << r.evaluationSteps << std::setw(12) << r.trainingReward << std::setw(12) << r.config.seed << std::endl;
+			out.unsetf(std::ios::floatfield);
+		}
+		out.precision(precision);
+	};
+private:
+	// The result of a single run
+	struct Run {
+		double score = 0.0;
+		double evaluationSteps = 0.0;
+		double trainingReward = 0.0;
+		double seconds = 0.0;
+		// The exception the run threw, if it failed
+		std::exception_ptr error;
+	};
+
+	/*
+	 * Returns the seed of a run, which only depends on the sweep's seed and the run's index
+	 */
+	unsigned runSeed(int run) const {
+		std::seed_seq seq{_seed, static_cast<unsigned>(run)};
+		unsigned seed;
+		seq.generate(&seed, &seed + 1);
+		return seed;
+	};
+
+	/*
+	 * Trains and evaluates a configuration on the calling thread
+	 */
+	void runOne(int run, Run &result) {
+		auto start = std::chrono::steady_clock::now();
+		QLLib::Utils::SweepConfig config = _configs[run / _repeats];
+		config.seed = runSeed(run);
+		QLLib::Utils::seedRandom(config.seed);
+		std::unique_ptr<QLLib::QLProblem> problem(_createProblem(config));
+		QLLib::QL ql(problem.get());
+		ql.setBudget(_budget);
+		// Average the rewards of the last 10% of the trials
+		int firstCounted = _trials - std::max(1, _trials / 10);
+		double rewards = 0.0;
+		int counted = 0;
+		ql.addEventListener([&](const QLLib::Utils::Stats &stats) {
+			if(stats.trialsCompleted > firstCounted) {
+				rewards += stats.rewardsPerTrial;
+				counted++;
+			}
+		});
+		ql.start(_trials);
+		result.trainingReward = (counted > 0) ? rewards / counted : 0.0;
+		if(_evaluationEpisodes > 0) {
+			QLLib::Utils::EvaluationOptions options;
+			options.maxSteps = _maxSteps;
+			QLLib::Utils::EvaluationStats evaluation = ql.evaluate(_evaluationEpisodes, options);
+			result.score = evaluation.meanReturn;
+			result.evaluationSteps = evaluation.meanSteps;
+		} else {
+			result.score = result.trainingReward;
+		}
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	ProblemFactory _createProblem;
+	std::vector<QLLib::Utils::SweepConfig> _configs;
+	std::vector<QLLib::Utils::SweepResult> _results;
+	int _trials = 1000;
+	QLLib::Utils::Budget _budget;
+	int _evaluationEpisodes = 10;
+	int _maxSteps = 10000;
+	int _repeats = 1;
+	int _threads = 0;
+	unsigned _seed = 0;
+};
+
+} /* namespace QLLib */
+
+#endif /* QLSWEEP_H_ */
@@ -1,90 +1,251 @@
-/*
- * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *     http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- *
- * QLUtils.h
- *
- *  Created on: Dec 15, 2015
- *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
- */
-
-#ifndef QLUTILS_H_
-#define QLUTILS_H_
-
-#include <sstream>
-#include <stdlib.h>
-#include <time.h>
-#include <random>
-
-namespace QLLib {
-namespace Utils {
-
-/*
- * Stats Struct
- * A utility struct to group stats data
- */
-struct Stats {
-	int trialsCompleted = 0;
-	int totalSteps = 0;
-	int stepsPerTrial = 0;
-	double rewardsPerTrial = 0.0;
-};
-
-/*
- * A utility function to convert an int to a string
- * This is for Windows users: MinGW on Windows doesn't have std::to_string yet :-(
- */
-std::string itos(int i) {
-	std::stringstream ss;
-	ss << i;
-	return ss.str();
-}
-
-/*
- * Check if all elements of an array are equal
- */
-bool arrayValuesEqual(double arr[], int size) {
-	double oldValue = arr[0];
-	for(int i=0;i<size;i++) {
-		if(oldValue != arr[i]) return false;
-		else oldValue = arr[i];
-	}
-	return true;
-}
-
-/*
- * Generates a random float between fMin and fMax
- * This is NOT very precise
- */
-double fRand(double fMin, double fMax) {
-	double f = (double) rand() / RAND_MAX;
-	return fMin + f * (fMax - fMin);
-}
-
-/*
- * Generates a random int between min and max
- * This is very precise, as it uses C++11
- */
-int iRand(int min, int max) {
-	std::random_device rd;
-	std::mt19937 rng(rd());
-	std::uniform_int_distribution<int> uni(min,max);
-	int randomNum = uni(rng);
-	return randomNum;
-}
-
-} /* namespace Utils */
-} /* namespace QLLib */
-
-#endif /* QLUTILS_H_ */
+/*
+ * Copyright 2015 Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QLUtils.h
+ *
+ *  Created on: Dec 15, 2015
+ *      Author: Gianluca Tiepolo <tiepolo.gian@gmail.com>
+ */
+
+#ifndef QLUTILS_H_
+#define QLUTILS_H_
+
+#include <cstdint>
+#include <sstream>
+#include <stdlib.h>
+#include <time.h>
+#include <random>
+#include <typeinfo>
+#include <type_traits>
+
+namespace QLLib {
+namespace Utils {
+
+/*
+ * Stats Struct
+ * A utility struct to group stats data
+ */
+struct Stats {
+	int64_t trialsCompleted = 0;
+	int64_t totalSteps = 0;
+	int stepsPerTrial = 0;
+	double rewardsPerTrial = 0.0;
+	// The largest and the mean change of a Q-value during the trial
+	double maxDeltaQ = 0.0;
+	double meanDeltaQ = 0.0;
+	// The number of updates that changed the greedy action of a state (only counted if the algorithms track it)
+	int policyChanges = 0;
+	// True if the trial didn't reach its end, but was stopped by the simulation's budget (see Budget)
+	bool truncated = false;
+};
+
+/*
+ * Budget Struct
+ * Limits on how long a simulation runs (0 means no limit).
+ * A trial that reaches a limit is stopped and reported as truncated; the run limits count from the start of each run
+ */
+struct Budget {
+	// The largest number of steps of a trial (i.e. to stop a policy that cycles forever)
+	int maxStepsPerTrial = 0;
+	// The largest number of steps of a run
+	int64_t maxSteps = 0;
+	// The largest number of trials of a run
+	int maxTrials = 0;
+	// The longest a run can last, in seconds of wall-clock time
+	double maxSeconds = 0.0;
+};
+
+/*
+ * Convergence Struct
+ * A utility struct to accumulate how much the Q-values change
+ */
+struct Convergence {
+	double maxDeltaQ = 0.0;
+	double sumDeltaQ = 0.0;
+	long updates = 0;
+	int policyChanges = 0;
+
+	/*
+	 * Adds the changes accumulated by another algorithm
+	 */
+	void merge(const Convergence &c) {
+		if(c.maxDeltaQ > maxDeltaQ) maxDeltaQ = c.maxDeltaQ;
+		sumDeltaQ += c.sumDeltaQ;
+		updates += c.updates;
+		policyChanges += c.policyChanges;
+	};
+
+	double meanDeltaQ() const {
+		return (updates > 0) ? sumDeltaQ / updates : 0.0;
+	};
+};
+
+/*
+ * EvaluationStats Struct
+ * The returns (the sum of the rewards of an episode) of the episodes run by QL::evaluate()
+ */
+struct EvaluationStats {
+	int episodes = 0;
+	// The number of episodes that were stopped after the step limit
+	int truncated = 0;
+	double meanReturn = 0.0;
+	double stdReturn = 0.0;
+	double minReturn = 0.0;
+	double maxReturn = 0.0;
+	double meanSteps = 0.0;
+};
+
+/*
+ * MemoryReport Struct
+ * The bytes used by a problem and its algorithms (see QLProblem::getMemoryUsage()),
+ * or predicted before they are allocated (see QLProblem::estimateMemory())
+ */
+struct MemoryReport {
+	// The state objects and the vectors that hold them
+	size_t states = 0;
+	// The action objects and the vectors that hold them
+	size_t actions = 0;
+	// The blocks of the problem's arena (states and actions created with emplaceState()/emplaceAction())
+	size_t arena = 0;
+	// The indices that find states by name and by key
+	size_t index = 0;
+	// The algorithms' Q-tables
+	size_t table = 0;
+	// The algorithms' visit counts
+	size_t visits = 0;
+
+	/*
+	 * Adds the bytes of another report (i.e. of another agent's algorithm)
+	 */
+	void merge(const MemoryReport &r) {
+		states += r.states;
+		actions += r.actions;
+		arena += r.arena;
+		index += r.index;
+		table += r.table;
+		visits += r.visits;
+	};
+
+	size_t total() const {
+		return states + actions + arena + index + table + visits;
+	};
+};
+
+/*
+ * IsStatic
+ * True when calls on T can be bound at compile time, that is when T is a concrete (non-abstract) class.
+ * Used to select between static and virtual dispatch in templated code: the static calls are qualified with T,
+ * so they would skip the overrides of a subclass of T, and objects must be exactly of type T (see isStaticType())
+ */
+template<class T>
+struct IsStatic : std::integral_constant<bool, !std::is_abstract<T>::value> {};
+
+/*
+ * Returns true if calls on an object can go through T's static dispatch: T is abstract (calls are virtual),
+ * or the object is exactly a T and not a subclass
+ */
+template<class T, class U>
+bool isStaticType(const U *object) {
+	return !IsStatic<T>::value || (typeid(*object) == typeid(T));
+}
+
+/*
+ * ConcurrentReads
+ * True when a Q-table of type Table can be read on one thread while another thread updates it,
+ * that is when its values are atomic and it never reallocates. Specialize it for such tables
+ */
+template<class Table>
+struct ConcurrentReads : std::false_type {};
+
+/*
+ * A utility function to convert an int to a string
+ * This is for Windows users: MinGW on Windows doesn't have std::to_string yet :-(
+ */
+inline std::string itos(int i) {
+	std::stringstream ss;
+	ss << i;
+	return ss.str();
+}
+
+/*
+ * Check if all elements of an array are equal
+ */
+template<class T>
+bool arrayValuesEqual(const T arr[], int size) {
+	T oldValue = arr[0];
+	for(int i=0;i<size;i++) {
+		if(oldValue != arr[i]) return false;
+		else oldValue = arr[i];
+	}
+	return true;
+}
+
+/*
+ * Returns the index of the largest element of an array (the first one, if there are several)
+ */
+template<class T>
+inline int indexOfLargest(const T arr[], int size) {
+	int largestIndex = 0;
+	for(int i = 1; i < size; i++) {
+		if(arr[largestIndex] < arr[i]) largestIndex = i;
+	}
+	return largestIndex;
+}
+
+/*
+ * Returns the calling thread's random number engine
+ * The engine is seeded once per thread, seeding it on every call is far too slow for the inner loop
+ */
+inline std::mt19937& randomEngine() {
+	static thread_local std::mt19937 engine(std::random_device{}());
+	return engine;
+}
+
+/*
+ * Seeds the calling thread's random number engine, so a run can be repeated exactly
+ */
+inline void seedRandom(unsigned seed) {
+	randomEngine().seed(seed);
+}
+
+/*
+ * Generates a random double in [0, 1) with the calling thread's engine
+ */
+inline double uniformRand() {
+	return std::generate_canonical<double, 32>(randomEngine());
+}
+
+/*
+ * Generates a random double between fMin and fMax
+ * Uses the calling thread's engine, so policies can sample from several threads
+ */
+inline double fRand(double fMin, double fMax) {
+	return fMin + uniformRand() * (fMax - fMin);
+}
+
+/*
+ * Generates a random int between min and max
+ * This is very precise, as it uses C++11
+ */
+inline int iRand(int min, int max) {
+	std::uniform_int_distribution<int> uni(min,max);
+	int randomNum = uni(randomEngine());
+	return randomNum;
+}
+
+} /* namespace Utils */
+} /* namespace QLLib */
+
+#endif /* QLUTILS_H_ */